@@ -10,8 +10,16 @@
  */
 #pragma once
 
+#include "lemlib/blackbox.hpp"
+#include "lemlib/channels.hpp"
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/controller.hpp"
+#include "lemlib/gainSchedule.hpp"
+#include "lemlib/heap.hpp"
+#include "lemlib/monitor.hpp"
 #include "lemlib/pid.hpp"
 #include "lemlib/pose.hpp"
+#include "lemlib/profiler.hpp"
+#include "lemlib/telemetry.hpp"
 #include "lemlib/util.hpp"
\ No newline at end of file
@@ -0,0 +1,92 @@
+/**
+ * @file include/lemlib/blackbox.hpp
+ * @author LemLib Team
+ * @brief Black box recorder, keeps the latest telemetry in RAM and saves it to the SD card
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+namespace blackbox {
+/**
+ * @brief Size of the recording kept in RAM, in bytes
+ *
+ * How many seconds this holds depends on how much telemetry is sent. For example, a pose and two motor groups of
+ * 3 motors every 10 ms is about 12 kB per second, so the recording holds the last 5 seconds
+ */
+constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+/**
+ * @brief How many recordings are kept on the SD card. The oldest is overwritten by the next one
+ */
+constexpr int MAX_FILES = 8;
+
+/**
+ * @brief Start the black box recorder
+ *
+ * Every telemetry record (see telemetry.hpp) is copied into RAM from now on, even if telemetry is not sent over
+ * the serial terminal. The recording is saved to /usd/blackbox<n>.bin when autonomous or driver control ends,
+ * when the robot is disabled, when a fatal error is logged, or when dump() is called.
+ * Files start with a BlackboxHeader_t, followed by telemetry frames that tools/telemetryDecode.cpp can decode
+ */
+void init();
+
+/**
+ * @brief Whether the black box recorder has been started
+ *
+ * @return true if the recorder is running
+ */
+bool isEnabled();
+
+/**
+ * @brief Add data to the recording
+ *
+ * Never waits. If another task is adding data or the recording is being copied, the data is dropped instead
+ *
+ * @param data the data
+ * @param length length of the data in bytes
+ */
+void record(const void* data, std::size_t length);
+
+/**
+ * @brief Save the recording to the SD card
+ *
+ * The recording is saved by a background task, so this returns immediately
+ *
+ * @param reason why the recording is saved. Must be a string literal, or outlive the save
+ */
+void dump(const char* reason);
+
+/**
+ * @brief Get the number of times data was dropped because the recording was busy
+ *
+ * @return the number of dropped records
+ */
+std::uint32_t getDropped();
+
+#pragma pack(push, 1)
+/**
+ * @brief Header at the start of every saved recording
+ *
+ * @param magic "LLBB"
+ * @param sequence number of the recording, counting up across reboots
+ * @param time time the recording was saved, in milliseconds since the program started
+ * @param reason why the recording was saved
+ */
+typedef struct {
+  char magic[4];
+  std::uint32_t sequence;
+  std::uint32_t time;
+  char reason[20];
+} BlackboxHeader_t;
+#pragma pack(pop)
+}  // namespace blackbox
+}  // namespace lemlib
@@ -0,0 +1,66 @@
+/**
+ * @file include/lemlib/channels.hpp
+ * @author LemLib Team
+ * @brief Telemetry channels, sampled at their own rates by one task
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <functional>
+
+namespace lemlib {
+namespace telemetry {
+/**
+ * @brief Maximum number of channels
+ */
+constexpr int MAX_CHANNELS = 32;
+
+/**
+ * @brief Maximum number of values in a channel
+ */
+constexpr int MAX_CHANNEL_VALUES = 8;
+
+/**
+ * @brief Fastest rate channels can be sampled at, in Hz
+ */
+constexpr int CHANNEL_TICK_RATE = 100;
+
+/**
+ * @brief Add a channel with several values
+ *
+ * Values that come from the same device should be in the same channel, so the device is read once per sample.
+ * Channels can be added before or after startChannels()
+ *
+ * @param name name of the channel, for example "odom.pose". The string is copied
+ * @param rate how often the channel is sampled, in Hz. Rounded to a whole number of 10 ms ticks
+ * @param count number of values in the channel, up to MAX_CHANNEL_VALUES
+ * @param getter function that writes the count values of the channel
+ * @return int id of the channel, -1 if there is no room for it
+ */
+int addChannel(const char* name, float rate, int count, std::function<void(float*)> getter);
+
+/**
+ * @brief Add a channel with one value
+ *
+ * @param name name of the channel, for example "intake.velocity". The string is copied
+ * @param rate how often the channel is sampled, in Hz. Rounded to a whole number of 10 ms ticks
+ * @param getter function that returns the value of the channel
+ * @return int id of the channel, -1 if there is no room for it
+ */
+int addChannel(const char* name, float rate, std::function<float()> getter);
+
+/**
+ * @brief Start the task that samples the channels
+ *
+ * Every 10 ms, the channels that are due are sampled and sent together in one CHANNELS record (see
+ * telemetryFormat.hpp), which goes to the serial terminal and the black box recorder like every other record.
+ * The names of the channels are sent once a second, so recordings that start at any point can be decoded
+ */
+void startChannels();
+}  // namespace telemetry
+}  // namespace lemlib
@@ -11,10 +11,19 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <utility>
+#include <functional>
+
 #include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/gainSchedule.hpp"
+#include "lemlib/motionProfile.hpp"
+#include "lemlib/pid.hpp"
 #include "lemlib/pose.hpp"
 #include "pros/imu.hpp"
 #include "pros/motors.hpp"
+#include "pros/rtos.hpp"
 
 namespace lemlib {
 /**
@@ -51,6 +60,11 @@ typedef struct {
  * @param largeError the error at which the chassis controller will switch to a faster control loop
  * @param largeErrorTimeout the time the chassis controller will wait before switching to a faster control loop
  * @param slew the maximum acceleration of the chassis controller
+ * @param settleError the error at which the chassis controller can exit once the robot has stopped
+ * @param settleVelocity the velocity below which the robot is considered stopped, in units of the error per second
+ * @param settleTime how long the robot has to stay stopped within settleError before exiting, in milliseconds
+ * @param schedule gain schedule that replaces kP and kD, keyed on the error and the battery voltage. Ignored if
+ * nullptr, and for a controller whose gains were posted from the terminal (see FAPID::init)
  */
 typedef struct {
   float kP;
@@ -60,8 +74,27 @@ typedef struct {
   float largeError;
   float largeErrorTimeout;
   float slew;
+  float settleError;
+  float settleVelocity;
+  float settleTime;
+  GainSchedule* schedule;
 } ChassisController_t;
 
+/**
+ * @brief Struct containing statistics of the last motion
+ *
+ * @param duration total time the motion took, in milliseconds
+ * @param settleTime time spent settling, from when the error first came within range until the motion exited, in
+ * milliseconds
+ * @param exit the exit condition that ended the motion. NONE if the motion was chained, canceled or has no exit
+ * conditions (follow and ramsete)
+ */
+typedef struct {
+  int duration;
+  int settleTime;
+  FAPID::Exit exit;
+} MotionStats_t;
+
 /**
  * @brief Struct containing constants for a drivetrain
  *
@@ -73,6 +106,11 @@ typedef struct {
  * @param trackWidth the track width of the robot
  * @param wheelDiameter the diameter of the wheels (2.75, 3.25, 4, 4.125)
  * @param rpm the rpm of the wheels
+ * @param maxVelocity the maximum velocity of the drivetrain in inches per second. Theoretical maximum if set to 0
+ * @param maxAcceleration the maximum acceleration of the drivetrain in inches per second squared
+ * @param maxDeceleration the maximum deceleration of the drivetrain in inches per second squared
+ * @param maxLateralAccel the maximum centripetal acceleration before the wheels slip, in inches per second squared
+ * @param maxJerk the maximum jerk of the drivetrain in inches per second cubed. Trapezoidal profiles if set to 0
  */
 typedef struct {
   pros::Motor_Group* leftMotors;
@@ -80,8 +118,76 @@ typedef struct {
   float trackWidth;
   float wheelDiameter;
   float rpm;
+  float maxVelocity;
+  float maxAcceleration;
+  float maxDeceleration;
+  float maxLateralAccel;
+  float maxJerk;
 } Drivetrain_t;
 
+/**
+ * @brief Struct containing constants for path following
+ *
+ * The constants are stored in a struct so that they can be easily passed to the chassis class
+ * Set a constant to 0 and it will be ignored
+ *
+ * @param minLookahead the smallest lookahead distance used by the adaptive lookahead, in inches. Also used by follow()
+ * when it is given a lookahead of 0 and the adaptive lookahead is disabled
+ * @param maxLookahead the largest lookahead distance used by the adaptive lookahead, in inches. Adaptive lookahead is
+ * disabled if set to 0
+ * @param lookaheadTime how far ahead the robot looks, in seconds of travel at its current velocity
+ * @param curvatureGain how much the curvature of the upcoming path shortens the lookahead
+ * @param ramseteB RAMSETE convergence gain, in 1/inches squared. Larger values correct errors more aggressively.
+ * 0.0013 is used if set to 0
+ * @param ramseteZeta RAMSETE damping gain, between 0 and 1. 0.7 is used if set to 0
+ */
+typedef struct {
+  float minLookahead;
+  float maxLookahead;
+  float lookaheadTime;
+  float curvatureGain;
+  float ramseteB;
+  float ramseteZeta;
+} FollowSettings_t;
+
+/**
+ * @brief Struct containing constants for the wheel velocity controllers
+ *
+ * The constants are stored in a struct so that they can be easily passed to the chassis class
+ * Set a constant to 0 and it will be ignored. Velocity control is disabled if kV is 0
+ * Use Chassis::characterize() to measure kS, kV and kA
+ *
+ * @param kS power needed to overcome static friction
+ * @param kV power per inch per second of wheel velocity
+ * @param kA power per inch per second squared of wheel acceleration
+ * @param kP power per inch per second of velocity error
+ */
+typedef struct {
+  float kS;
+  float kV;
+  float kA;
+  float kP;
+} VelocityController_t;
+
+/**
+ * @brief A side of the drivetrain
+ *
+ */
+enum class DriveSide { LEFT, RIGHT };
+
+/**
+ * @brief How the outputs of the position and heading controllers drive the motors
+ *
+ * VOLTAGE: the output is sent to the motors as a voltage
+ * MOTOR_VELOCITY: the output is a wheel velocity target, held by the velocity controllers built into the motors
+ * WHEEL_VELOCITY: the output is a wheel velocity target, held by the wheel velocity controllers (see
+ * VelocityController_t). Falls back to MOTOR_VELOCITY if kV is 0
+ *
+ * The velocity modes make motions independent of the battery voltage and the load on the robot.
+ * An output of 127 is the max velocity of the drivetrain
+ */
+enum class OutputMode { VOLTAGE, MOTOR_VELOCITY, WHEEL_VELOCITY };
+
 /**
  * @brief Chassis class
  *
@@ -95,9 +201,11 @@ class Chassis {
    * @param lateralSettings settings for the lateral controller
    * @param angularSettings settings for the angular controller
    * @param sensors sensors to be used for odometry
+   * @param followSettings settings for path following. Optional
+   * @param velocitySettings settings for the wheel velocity controllers. Optional
    */
   Chassis(Drivetrain_t drivetrain, ChassisController_t lateralSettings, ChassisController_t angularSettings,
-          OdomSensors_t sensors);
+          OdomSensors_t sensors, FollowSettings_t followSettings = {}, VelocityController_t velocitySettings = {});
   /**
    * @brief Calibrate the chassis sensors
    *
@@ -133,10 +241,33 @@ class Chassis {
    * @return Pose
    */
   Pose getPose(bool radians = false);
+  /**
+   * @brief Get the motion profile moveTo uses to drive a distance
+   *
+   * Use getDuration() on the profile to find how long the motion will take before running it
+   *
+   * @param distance the distance to drive in inches
+   * @param maxSpeed the maximum speed the robot can move at. 127 by default
+   * @return MotionProfile the profile
+   */
+  MotionProfile lateralProfile(float distance, float maxSpeed = 127);
+  /**
+   * @brief Get the motion profile turnTo uses to turn an angle
+   *
+   * Use getDuration() on the profile to find how long the motion will take before running it
+   *
+   * @param angle the angle to turn in degrees
+   * @param maxSpeed the maximum speed the robot can turn at. 127 by default
+   * @param swing whether the turn is a swing turn, pivoting around one side of the drivetrain. false by default
+   * @return MotionProfile the profile
+   */
+  MotionProfile angularProfile(float angle, float maxSpeed = 127, bool swing = false);
   /**
    * @brief Turn the chassis so it is facing the target point
    *
    * The PID logging id is "angularPID"
+   * If motion profiles are enabled (see setMotionProfiles) the turn follows a motion profile (see angularProfile),
+   * unless it is chained or starts where a chained motion exited
    *
    * @param x x location
    * @param y y location
@@ -144,46 +275,359 @@ class Chassis {
    * @param reversed whether the robot should turn in the opposite direction. false by default
    * @param maxSpeed the maximum speed the robot can turn at. Default is 200
    * @param log whether the chassis should log the turnTo function. false by default
+   * @param async whether the function should return immediately and run the motion on the motion task. false by
+   * default
+   * @param minSpeed the minimum speed the robot turns at. If not 0, the motion is chained: it exits once within
+   * earlyExitRange of the target without stopping, and hands its speed to the next motion. 0 by default
+   * @param earlyExitRange how close to the target the chained motion exits, in degrees. 0 by default
+   */
+  void turnTo(float x, float y, int timeout, bool reversed = false, float maxSpeed = 127, bool log = false,
+              bool async = false, float minSpeed = 0, float earlyExitRange = 0);
+  /**
+   * @brief Turn the chassis to face a heading
+   *
+   * The PID logging id is "angularPID"
+   * If motion profiles are enabled (see setMotionProfiles) the turn follows a motion profile (see angularProfile),
+   * unless it is chained or starts where a chained motion exited
+   *
+   * @param heading the heading to face, in degrees
+   * @param timeout longest time the robot can spend moving
+   * @param maxSpeed the maximum speed the robot can turn at. 127 by default
+   * @param log whether the chassis should log the turnToHeading function. false by default
+   * @param async whether the function should return immediately and run the motion on the motion task. false by
+   * default
+   * @param minSpeed the minimum speed the robot turns at. If not 0, the motion is chained: it exits once within
+   * earlyExitRange of the target without stopping, and hands its speed to the next motion. 0 by default
+   * @param earlyExitRange how close to the target the chained motion exits, in degrees. 0 by default
+   */
+  void turnToHeading(float heading, int timeout, float maxSpeed = 127, bool log = false, bool async = false,
+                     float minSpeed = 0, float earlyExitRange = 0);
+  /**
+   * @brief Swing the chassis to face a heading, pivoting around one side of the drivetrain
+   *
+   * The locked side holds its position while the other side drives. The PID logging id is "angularPID"
+   * If motion profiles are enabled (see setMotionProfiles) the turn follows a motion profile (see angularProfile),
+   * unless it is chained or starts where a chained motion exited
+   *
+   * @param heading the heading to face, in degrees
+   * @param lockedSide the side of the drivetrain that does not move
+   * @param timeout longest time the robot can spend moving
+   * @param maxSpeed the maximum speed the moving side can drive at. 127 by default
+   * @param log whether the chassis should log the swingToHeading function. false by default
+   * @param async whether the function should return immediately and run the motion on the motion task. false by
+   * default
+   * @param minSpeed the minimum speed the robot turns at. If not 0, the motion is chained: it exits once within
+   * earlyExitRange of the target without stopping, and hands its speed to the next motion. 0 by default
+   * @param earlyExitRange how close to the target the chained motion exits, in degrees. 0 by default
    */
-  void turnTo(float x, float y, int timeout, bool reversed = false, float maxSpeed = 127, bool log = false);
+  void swingToHeading(float heading, DriveSide lockedSide, int timeout, float maxSpeed = 127, bool log = false,
+                      bool async = false, float minSpeed = 0, float earlyExitRange = 0);
   /**
    * @brief Move the chassis towards the target point
    *
    * The PID logging ids are "angularPID" and "lateralPID"
+   * If motion profiles are enabled (see setMotionProfiles) the robot follows a motion profile (see lateralProfile),
+   * unless the motion is chained or starts where a chained motion exited
    *
    * @param x x location
    * @param y y location
    * @param timeout longest time the robot can spend moving
    * @param maxSpeed the maximum speed the robot can move at
    * @param log whether the chassis should log the turnTo function. false by default
+   * @param async whether the function should return immediately and run the motion on the motion task. false by
+   * default
+   * @param minSpeed the minimum speed the robot drives at. If not 0, the motion is chained: it exits once within
+   * earlyExitRange of the target without stopping, and hands its speed to the next motion. 0 by default
+   * @param earlyExitRange how close to the target the chained motion exits, in inches. 0 by default
+   */
+  void moveTo(float x, float y, int timeout, float maxSpeed = 200, bool log = false, bool async = false,
+              float minSpeed = 0, float earlyExitRange = 0);
+  /**
+   * @brief Move the chassis to a pose, arriving at the target heading
+   *
+   * The robot drives towards a carrot point behind the target, so it curves into the target heading without
+   * a separate turn. The PID logging ids are "angularPID" and "lateralPID"
+   *
+   * @param x x location
+   * @param y y location
+   * @param theta target heading in degrees, of the front of the robot even when driving backwards
+   * @param timeout longest time the robot can spend moving
+   * @param reversed whether the robot should drive backwards. false by default
+   * @param lead how far the carrot point is placed behind the target, as a ratio of the distance to the target.
+   * Larger values make wider curves. 0.6 by default
+   * @param maxSpeed the maximum speed the robot can move at. 127 by default
+   * @param log whether the chassis should log the moveToPose function. false by default
+   * @param async whether the function should return immediately and run the motion on the motion task. false by
+   * default
+   * @param minSpeed the minimum speed the robot drives at. If not 0, the motion is chained: it exits once within
+   * earlyExitRange of the target without stopping, and hands its speed to the next motion. 0 by default
+   * @param earlyExitRange how close to the target the chained motion exits, in inches. 0 by default
    */
-  void moveTo(float x, float y, int timeout, float maxSpeed = 200, bool log = false);
+  void moveToPose(float x, float y, float theta, int timeout, bool reversed = false, float lead = 0.6,
+                  float maxSpeed = 127, bool log = false, bool async = false, float minSpeed = 0,
+                  float earlyExitRange = 0);
   /**
    * @brief Move the chassis along a path
    *
    * @param filePath file path to the path. No need to preface it with /usd/
    * @param timeout the maximum time the robot can spend moving
    * @param lookahead the lookahead distance. Units in inches. Larger values will make the robot move faster but
-   * will follow the path less accurately
+   * will follow the path less accurately. Set to 0 to use the adaptive lookahead from the follow settings. If the
+   * adaptive lookahead is disabled, 0 uses the min lookahead of the follow settings, or 15 inches if that is 0 too
    * @param reverse whether the robot should follow the path in reverse. false by default
    * @param maxSpeed the maximum speed the robot can move at
    * @param log whether the chassis should log the path on a log file. false by default.
+   * @param async whether the function should return immediately and run the motion on the motion task. false by
+   * default
    */
   void follow(const char* filePath, int timeout, float lookahead, bool reverse = false, float maxSpeed = 127,
-              bool log = false);
+              bool log = false, bool async = false);
+  /**
+   * @brief Move the chassis along a path with a RAMSETE controller
+   *
+   * Unlike follow(), the path is time-parameterized and the robot tracks both the position and the heading of the
+   * path at each moment, so it does not cut corners. The gains are set in the follow settings. Once the trajectory is
+   * done, the robot keeps driving to the end of the path until it is within the small error of the lateral
+   * controller, or the timeout runs out
+   *
+   * @param filePath file path to the path. No need to preface it with /usd/
+   * @param timeout the maximum time the robot can spend moving
+   * @param reverse whether the robot should follow the path in reverse. false by default
+   * @param maxSpeed the maximum speed the robot can move at
+   * @param async whether the function should return immediately and run the motion on the motion task. false by
+   * default
+   */
+  void ramsete(const char* filePath, int timeout, bool reverse = false, float maxSpeed = 127, bool async = false);
+  /**
+   * @brief Wait until the current motion and all queued motions are done
+   *
+   */
+  void waitUntilDone();
+  /**
+   * @brief Wait until the current motion has travelled a distance, or has ended
+   *
+   * Turns measure their distance in degrees
+   *
+   * @param dist the distance to wait for, in inches (or degrees for turns)
+   */
+  void waitUntilDistance(float dist);
+  /**
+   * @brief Whether the chassis is running a motion, or has motions queued
+   *
+   * A motion that started in another competition state is not running. PROS deletes the autonomous and opcontrol
+   * tasks when the competition state changes, so a motion running on one of them never ends on its own
+   *
+   * @return true - a motion is running or queued
+   * @return false - the chassis is idle
+   */
+  bool isInMotion();
+  /**
+   * @brief Cancel the current motion and all queued motions
+   *
+   */
+  void cancel();
+  /**
+   * @brief Get the statistics of the last motion that finished
+   *
+   * Useful to find where an autonomous routine spends its time waiting for motions to settle
+   *
+   * @return MotionStats_t the statistics
+   */
+  MotionStats_t getMotionStats();
+  /**
+   * @brief Set how turnTo, turnToHeading, swingToHeading, moveTo and moveToPose drive the motors
+   *
+   * @param mode the output mode. VOLTAGE by default
+   */
+  void setOutputMode(OutputMode mode);
+  /**
+   * @brief Set whether turnTo, turnToHeading, swingToHeading and moveTo follow motion profiles
+   *
+   * The profiles use the max acceleration and jerk of the drivetrain, so they are only followed if it has a max
+   * acceleration. The controllers track the setpoint of the profile with feedforward, which needs the velocity
+   * constants or a velocity output mode: with the voltage output and no velocity constants, the feedforward only
+   * scales the velocity of the profile to power, and profiled motions are slower than unprofiled ones
+   *
+   * @param enabled whether the motions follow motion profiles. false by default
+   */
+  void setMotionProfiles(bool enabled);
+  /**
+   * @brief Add telemetry channels for the chassis (see channels.hpp)
+   *
+   * Adds "odom.pose" (x, y, theta), "chassis.velocity" (left and right wheel velocity in inches per second) and
+   * "chassis.temperature" (hottest left and right motor, in degrees celsius)
+   *
+   * @param poseRate how often the pose is sampled, in Hz. 50 by default
+   * @param velocityRate how often the wheel velocities are sampled, in Hz. 20 by default
+   * @param temperatureRate how often the motor temperatures are sampled, in Hz. 1 by default
+   */
+  void addTelemetry(float poseRate = 50, float velocityRate = 20, float temperatureRate = 1);
+
+  /**
+   * @brief Measure the feedforward constants of the drivetrain
+   *
+   * The robot drives forward while slowly ramping up power to measure kS and kV, then drives back with a step in
+   * power to measure kA. Make sure the robot has room to drive maxDistance inches forwards.
+   * The results are printed to the terminal.
+   *
+   * @param maxDistance the furthest the robot can drive during each test, in inches
+   * @param rampRate how fast the power ramps up during the first test, in power per second. 10 by default
+   * @param stepPower the power used during the second test. 80 by default
+   * @return VelocityController_t the measured constants. kP is always 0
+   */
+  VelocityController_t characterize(float maxDistance, float rampRate = 10, float stepPower = 80);
+  /**
+   * @brief Tune the lateral or angular controller with relay feedback
+   *
+   * The robot drives back and forth (or turns back and forth) around where it started with full relay power,
+   * and the ultimate gain and period of the oscillation are measured. kP and kD candidates are printed to the
+   * terminal. The robot moves a few inches (or degrees) either way, so give it some room.
+   *
+   * @param angular whether to tune the angular controller (true) or the lateral controller (false)
+   * @param relayPower the power of the relay. 50 by default
+   * @param cycles how many oscillations to measure. 5 by default
+   * @param filePath file to save the gains to, for loadGains(). No need to preface it with /usd/. Not saved if
+   * nullptr, which is the default
+   * @return ChassisController_t the current settings of the controller, with the tuned kP and kD (no overshoot
+   * candidate). Unchanged if tuning failed
+   */
+  ChassisController_t autotune(bool angular, float relayPower = 50, int cycles = 5, const char* filePath = nullptr);
+  /**
+   * @brief Load gains saved by autotune into the lateral or angular controller
+   *
+   * @param angular whether to load the angular controller (true) or the lateral controller (false)
+   * @param filePath file the gains were saved to. No need to preface it with /usd/
+   * @return true the gains were loaded
+   * @return false the file could not be read, the gains are unchanged
+   */
+  bool loadGains(bool angular, const char* filePath);
 
   void set_drive_brake(pros::motor_brake_mode_e_t brake_type);
 
   void set_tank(int left, int right);
 
+  /**
+   * @brief Drive with tank controls, holding the robot in place when the sticks are released
+   *
+   * When the sticks are released, the position of each side is latched, and the sides are driven back to it with
+   * a P controller. The sensors are never reset, so odometry keeps working in driver control
+   *
+   * @param l_stick power of the left side
+   * @param r_stick power of the right side
+   * @param active_brake_kp gain of the active brake, in power per degree of the motors. 0 disables the brake
+   */
   void drive(int l_stick, int r_stick, double active_brake_kp);
 
   void reset_drive_sensor();
 
  private:
+  /**
+   * @brief Get the position of one side of the drivetrain
+   *
+   * @param side the side
+   * @return float mean position of the motors of the side, in the units of their encoders
+   */
+  float drivePosition(DriveSide side);
   ChassisController_t lateralSettings;
   ChassisController_t angularSettings;
+  FollowSettings_t followSettings;
+  VelocityController_t velocitySettings;
   Drivetrain_t drivetrain;
   OdomSensors_t odomSensors;
+
+  /**
+   * @brief Queue a motion to run on the motion task
+   *
+   * @param motion the motion to run
+   */
+  void queueMotion(std::function<void()> motion);
+  /**
+   * @brief Mark the start of a motion. Waits for queued motions first, unless called from the motion task
+   *
+   */
+  void startMotion();
+  /**
+   * @brief Mark the end of a motion
+   *
+   */
+  void endMotion();
+  /**
+   * @brief Update the gains of a controller from its gain schedule, if it has one
+   *
+   * Gains posted from the terminal replace the schedule, so they are not overwritten while they are being tuned
+   *
+   * @param pid the controller
+   * @param settings the settings of the controller
+   * @param error the error the controller is fed
+   */
+  void scheduleGains(FAPID& pid, const ChassisController_t& settings, float error);
+  /**
+   * @brief Record the statistics of a motion
+   *
+   * @param start the time the motion started, in milliseconds
+   * @param pid the controller that decides when the motion exits
+   */
+  void recordStats(int start, FAPID& pid);
+  /**
+   * @brief Turn the chassis to face a point or a heading
+   *
+   * Shared by turnTo, turnToHeading and swingToHeading
+   *
+   * @param x x location of the point to face
+   * @param y y location of the point to face
+   * @param heading the heading to face, in degrees. Only used if facePoint is false
+   * @param facePoint whether to face the point (true) or the heading (false)
+   * @param reversed whether the back of the robot should face the point
+   * @param swing whether to swing around one side of the drivetrain instead of turning in place
+   * @param lockedSide the side of the drivetrain that does not move during a swing
+   * @param timeout longest time the robot can spend moving
+   * @param maxSpeed the maximum speed the robot can turn at
+   * @param log whether the chassis should log the turn
+   * @param minSpeed the minimum speed the robot turns at. If not 0, the motion is chained
+   * @param earlyExitRange how close to the target heading the chained motion exits, in degrees
+   */
+  void turn(float x, float y, float heading, bool facePoint, bool reversed, bool swing, DriveSide lockedSide,
+            int timeout, float maxSpeed, bool log, float minSpeed, float earlyExitRange);
+  /**
+   * @brief Stop the drivetrain at the end of a motion
+   *
+   * The next motion starts from rest
+   */
+  void stop();
+  /**
+   * @brief Calculate the motor power needed to drive the wheels at a velocity
+   *
+   * Uses the velocity controller feedforward if it is set, otherwise scales the velocity by the max velocity
+   *
+   * @param velocity wheel velocity in inches per second
+   * @param acceleration wheel acceleration in inches per second squared
+   * @return float motor power, out of 127
+   */
+  float feedforward(float velocity, float acceleration);
+  /**
+   * @brief Drive one side of the drivetrain with the output of a controller, using the output mode
+   *
+   * @param side the side of the drivetrain
+   * @param power the output of the controller, out of 127
+   */
+  void output(DriveSide side, float power);
+  float chainLateralPower = 0;
+  float chainAngularPower = 0;
+  std::atomic<bool> motionRunning = false;
+  std::atomic<std::uint8_t> motionState = 0;  // competition state the running motion started in
+  std::atomic<bool> motionCanceled = false;
+  std::atomic<int> motionsQueued = 0;
+  std::atomic<float> distTravelled = -1;
+  std::deque<std::pair<std::uint8_t, std::function<void()>>> motionQueue;  // competition state when queued, motion
+  pros::Mutex motionMutex;
+  MotionStats_t motionStats = {0, 0, FAPID::Exit::NONE};
+  OutputMode outputMode = OutputMode::VOLTAGE;
+  bool motionProfiles = false;
+  float prevLeftVelocity = 0;   // wheel velocity targets of the last output, in inches per second
+  float prevRightVelocity = 0;
+  bool brakeLatched = false;  // whether the active brake has latched its hold positions
+  float leftHold = 0;
+  float rightHold = 0;
+  pros::Task* motionTask = nullptr;
 };
 }  // namespace lemlib
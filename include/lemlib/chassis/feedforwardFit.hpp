@@ -0,0 +1,68 @@
+/**
+ * @file include/lemlib/chassis/feedforwardFit.hpp
+ * @author LemLib Team
+ * @brief Least squares fit of the drivetrain feedforward constants
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "lemlib/chassis/chassis.hpp"
+
+namespace lemlib {
+/**
+ * @brief Fits the feedforward constants of the drivetrain to the samples of Chassis::characterize()
+ *
+ * Like the control laws in motionControl.hpp, the fit doesn't read sensors or drive motors, so the host simulations
+ * in tools/sim run the same characterization as the robot
+ */
+class FeedforwardFit {
+ public:
+  /**
+   * @brief Add a sample of the quasi-static test, where the power ramps up slowly
+   *
+   * Samples where the robot has not started moving are ignored
+   *
+   * @param power the power of the drivetrain, out of 127
+   * @param velocity the wheel velocity, in inches per second
+   */
+  void addRampSample(float power, float velocity);
+  /**
+   * @brief Fit kS and kV to the samples of the quasi-static test, with power = kS + kV * velocity
+   *
+   * @return true - the fit succeeded
+   * @return false - the robot did not move
+   */
+  bool fitRamp();
+  /**
+   * @brief Add a sample of the dynamic test, where the power steps up and the robot accelerates
+   *
+   * Samples where the robot is not accelerating are ignored
+   *
+   * @param power the power of the drivetrain, out of 127
+   * @param velocity the wheel velocity, in inches per second
+   * @param acceleration the wheel acceleration, in inches per second squared
+   */
+  void addStepSample(float power, float velocity, float acceleration);
+  /**
+   * @brief Get the fitted constants. kA is fit to the power kS and kV leave over in the dynamic test
+   *
+   * @return VelocityController_t the constants. kP is always 0
+   */
+  VelocityController_t getConstants();
+ private:
+  float n = 0;
+  float sumV = 0;
+  float sumP = 0;
+  float sumVV = 0;
+  float sumVP = 0;
+  float sumAA = 0;
+  float sumAR = 0;
+  float kS = 0;
+  float kV = 0;
+};
+}  // namespace lemlib
@@ -0,0 +1,223 @@
+/**
+ * @file include/lemlib/chassis/motionControl.hpp
+ * @author LemLib Team
+ * @brief Control laws of the chassis motions
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/motionProfile.hpp"
+#include "lemlib/pid.hpp"
+#include "lemlib/pose.hpp"
+
+// The functions and classes below don't read sensors, drive motors or wait. The chassis motions call them once per
+// loop with the pose of the robot and the time, and send their outputs to the motors. The host simulations in
+// tools/sim call the same code on a simulated drivetrain
+
+namespace lemlib {
+/**
+ * @brief Struct containing the constants of a chassis that the control laws of its motions use
+ *
+ * @param drivetrain the drivetrain
+ * @param lateralSettings settings for the lateral controller
+ * @param angularSettings settings for the angular controller
+ * @param velocitySettings settings for the wheel velocity controllers
+ * @param outputMode how the outputs of the controllers drive the motors
+ */
+typedef struct {
+  Drivetrain_t drivetrain;
+  ChassisController_t lateralSettings;
+  ChassisController_t angularSettings;
+  VelocityController_t velocitySettings;
+  OutputMode outputMode;
+} ChassisConstants_t;
+
+/**
+ * @brief Struct containing the command for the motors of one side of the drivetrain
+ *
+ * @param velocity whether value is a velocity for the velocity controllers built into the motors, instead of power
+ * @param value power out of 127, or velocity in inches per second
+ */
+typedef struct {
+  bool velocity;
+  float value;
+} SideOutput_t;
+
+/**
+ * @brief Get the power for one side of the drivetrain from the wheel velocity controller
+ *
+ * kS/kV/kA feedforward, plus proportional feedback on the measured velocity
+ *
+ * @param constants the velocity controller constants
+ * @param targetVelocity the target wheel velocity in inches per second
+ * @param targetAcceleration the target wheel acceleration in inches per second squared
+ * @param velocity the measured wheel velocity in inches per second. Only used if kP is not 0
+ * @return float power out of 127
+ */
+float wheelPower(VelocityController_t constants, float targetVelocity, float targetAcceleration, float velocity);
+
+/**
+ * @brief Get the command for one side of the drivetrain from the output of a controller, using the output mode
+ *
+ * @param constants the constants of the chassis
+ * @param power the output of the controller, out of 127
+ * @param prevVelocity the velocity of the last output of this side, in inches per second. Updated
+ * @param velocity the measured wheel velocity in inches per second. Only used by the wheel velocity controller
+ * @return SideOutput_t the command
+ */
+SideOutput_t sideOutput(const ChassisConstants_t& constants, float power, float& prevVelocity, float velocity);
+
+/**
+ * @brief Calculate the motor power needed to drive the wheels at a velocity
+ *
+ * Uses the velocity controller feedforward if it is set, otherwise scales the velocity by the max velocity
+ *
+ * @param constants the constants of the chassis
+ * @param velocity wheel velocity in inches per second
+ * @param acceleration wheel acceleration in inches per second squared
+ * @return float motor power, out of 127
+ */
+float feedforward(const ChassisConstants_t& constants, float velocity, float acceleration);
+
+/**
+ * @brief Update the gains of a controller from its gain schedule, if it has one
+ *
+ * Gains posted from the terminal replace the schedule, so they are not overwritten while they are being tuned
+ *
+ * @param pid the controller
+ * @param settings the settings of the controller
+ * @param error the error the controller is fed
+ * @param batteryVoltage the battery voltage, in volts
+ */
+void scheduleGains(FAPID& pid, const ChassisController_t& settings, float error, float batteryVoltage);
+
+/**
+ * @brief Get the motion profile moveTo uses to drive a distance
+ *
+ * @param drivetrain the drivetrain
+ * @param distance the distance to drive in inches
+ * @param maxSpeed the maximum speed the robot can move at
+ * @return MotionProfile the profile
+ */
+MotionProfile lateralProfile(const Drivetrain_t& drivetrain, float distance, float maxSpeed);
+
+/**
+ * @brief Get the motion profile turnTo uses to turn an angle
+ *
+ * The angular limits are the linear limits of the wheels, turning about the center of the robot,
+ * or about the locked side for a swing turn
+ *
+ * @param drivetrain the drivetrain
+ * @param angle the angle to turn in degrees
+ * @param maxSpeed the maximum speed the robot can turn at
+ * @param swing whether the turn is a swing turn, pivoting around one side of the drivetrain
+ * @return MotionProfile the profile
+ */
+MotionProfile angularProfile(const Drivetrain_t& drivetrain, float angle, float maxSpeed, bool swing);
+
+/**
+ * @brief Control law of Chassis::moveTo()
+ *
+ * Drives toward a point with a lateral and an angular controller. If the motion is profiled, the lateral controller
+ * tracks the setpoint of a motion profile with feedforward. If the motion is chained, it exits once close to the
+ * target without stopping
+ */
+class MoveToController {
+ public:
+  /**
+   * @brief Construct a new Move To Controller
+   *
+   * @param constants the constants of the chassis
+   * @param x x location of the target
+   * @param y y location of the target
+   * @param timeout longest time the robot can spend moving, in milliseconds
+   * @param maxSpeed the maximum speed the robot can move at
+   * @param minSpeed the minimum speed the robot drives at. If not 0, the motion is chained
+   * @param earlyExitRange how close to the target the chained motion exits, in inches
+   * @param profile whether the motion follows a motion profile. Profiles start from rest, so chained motions
+   * and motions that start where a chained motion exited never do
+   * @param chainLateralPower lateral power handed over by the previous motion. 0 if it stopped
+   * @param chainAngularPower angular power handed over by the previous motion. 0 if it stopped
+   */
+  MoveToController(const ChassisConstants_t& constants, float x, float y, int timeout, float maxSpeed,
+                   float minSpeed, float earlyExitRange, bool profile, float chainLateralPower,
+                   float chainAngularPower);
+  /**
+   * @brief Update the controller. Must be called every 10 ms
+   *
+   * @param pose the pose of the robot, with theta in degrees
+   * @param time time since the start of the motion, in seconds
+   * @param batteryVoltage the battery voltage, in volts. Used by the gain schedules
+   * @param log whether the controllers check for gains posted from the terminal
+   * @return true - the motion is running, drive the motors with getLeftPower() and getRightPower()
+   * @return false - the motion has exited
+   */
+  bool update(Pose pose, float time, float batteryVoltage, bool log);
+  /**
+   * @brief Get the output for the left side of the drivetrain
+   *
+   * @return float power out of 127
+   */
+  float getLeftPower();
+  /**
+   * @brief Get the output for the right side of the drivetrain
+   *
+   * @return float power out of 127
+   */
+  float getRightPower();
+  /**
+   * @brief Whether the motion exited as a chained motion, and hands its speed to the next motion
+   *
+   * @return true - the motion is chained and has exited
+   * @return false - the motion is running, or has settled
+   */
+  bool isChained();
+  /**
+   * @brief Get the last lateral output, which a chained motion hands to the next motion
+   *
+   * @return float power out of 127
+   */
+  float getLateralPower();
+  /**
+   * @brief Get the last angular output, which a chained motion hands to the next motion
+   *
+   * @return float power out of 127
+   */
+  float getAngularPower();
+  /**
+   * @brief Get the lateral controller, which decides when the motion exits
+   *
+   * @return FAPID& the controller
+   */
+  FAPID& getLateralPID();
+ private:
+  ChassisConstants_t constants;
+  float x;
+  float y;
+  float maxSpeed;
+  float minSpeed;
+  float earlyExitRange;
+  bool profiled;
+  FAPID lateralPID;
+  FAPID angularPID;
+  MotionProfile profile = MotionProfile(0, 0, 0);
+  Pose prevPose = Pose(0, 0, 0);
+  bool started = false;
+  float velocity = 0;  // measured speed, in inches per second
+  float startSign = 0;
+  float startDistance = 0;
+  bool profileDone;
+  bool close = false;
+  bool chained = false;
+  float prevLateralPower;
+  float prevAngularPower;
+  float leftPower = 0;
+  float rightPower = 0;
+};
+}  // namespace lemlib
@@ -0,0 +1,214 @@
+/**
+ * @file include/lemlib/chassis/pathFollower.hpp
+ * @author LemLib Team
+ * @brief Pure pursuit and RAMSETE path followers
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/pathProfile.hpp"
+#include "lemlib/pose.hpp"
+
+// Like the motion control laws in motionControl.hpp, the followers don't read sensors, drive motors or wait.
+// Chassis::follow() and Chassis::ramsete() call them once per loop, and so do the host simulations in tools/sim
+
+namespace lemlib {
+/**
+ * @brief find the closest point on the path to the robot
+ *
+ * @param pose the current pose of the robot
+ * @param path the path to follow
+ * @return int index to the closest point
+ */
+int findClosest(Pose pose, const std::vector<Pose>& path);
+
+/**
+ * @brief Function that finds the intersection point between a circle and a line
+ *
+ * @param p1 start point of the line
+ * @param p2 end point of the line
+ * @param pose position of the robot
+ * @param lookaheadDist the radius of the circle around the robot
+ * @return float how far along the line the intersection is, between 0 and 1. -1 if there is none
+ */
+float circleIntersect(Pose p1, Pose p2, Pose pose, float lookaheadDist);
+
+/**
+ * @brief returns the lookahead point
+ *
+ * @param lastLookahead the last lookahead point. Its theta is the index of the segment it is on
+ * @param pose the current position of the robot
+ * @param path the path to follow
+ * @param lookaheadDist the lookahead distance
+ * @return Pose the lookahead point. Its theta is the index of the segment it is on
+ */
+Pose lookaheadPoint(Pose lastLookahead, Pose pose, const std::vector<Pose>& path, float lookaheadDist);
+
+/**
+ * @brief Get the curvature of a circle that intersects the robot and the lookahead point
+ *
+ * @param pose the position of the robot
+ * @param heading the heading of the robot
+ * @param lookahead the lookahead point
+ * @return double curvature
+ */
+double findLookaheadCurvature(Pose pose, double heading, Pose lookahead);
+
+/**
+ * @brief Calculate the lookahead distance for the adaptive lookahead
+ *
+ * The lookahead grows with the velocity of the robot and shrinks when the path ahead of the robot curves,
+ * so straights are driven with a long lookahead and tight turns with a short one
+ *
+ * @param settings the follow settings
+ * @param velocity the current velocity of the robot, in inches per second
+ * @param closestPoint index of the closest point on the path
+ * @param path the path to follow
+ * @param curvatures curvature of the path at each point
+ * @return float lookahead distance in inches
+ */
+float adaptiveLookahead(FollowSettings_t settings, float velocity, int closestPoint, const std::vector<Pose>& path,
+                        const std::vector<float>& curvatures);
+
+/**
+ * @brief Sample a trajectory at a point in time
+ *
+ * @param trajectory the trajectory
+ * @param index index of the last sampled segment. Updated to the segment containing time
+ * @param time time since the start of the trajectory, in seconds
+ * @return TrajectoryPoint_t the interpolated point
+ */
+TrajectoryPoint_t sampleTrajectory(const std::vector<TrajectoryPoint_t>& trajectory, int& index, float time);
+
+/**
+ * @brief Pure pursuit path follower, used by Chassis::follow()
+ */
+class PurePursuit {
+ public:
+  /**
+   * @brief Construct a new Pure Pursuit follower
+   *
+   * @param path the path, profiled by profilePath()
+   * @param drivetrain the drivetrain
+   * @param followSettings the follow settings
+   * @param velocitySettings the wheel velocity constants. Velocities are scaled to power if kV is 0
+   * @param lookahead the lookahead distance in inches. 0 for the adaptive lookahead, see Chassis::follow()
+   * @param reverse whether the robot follows the path in reverse
+   * @param maxSpeed the maximum speed the robot can move at
+   */
+  PurePursuit(const std::vector<Pose>& path, Drivetrain_t drivetrain, FollowSettings_t followSettings,
+              VelocityController_t velocitySettings, float lookahead, bool reverse, float maxSpeed);
+  /**
+   * @brief Update the follower
+   *
+   * @param pose the pose of the robot, with theta in radians
+   * @param dt time since the last update, in seconds. Ignored on the first update
+   * @param leftVelocity measured velocity of the left wheels, in inches per second. Only used by the wheel velocity
+   * controller if its kP is not 0
+   * @param rightVelocity measured velocity of the right wheels, in inches per second
+   * @return true - the robot is following the path, drive the motors with getLeftPower() and getRightPower()
+   * @return false - the robot has reached the end of the path
+   */
+  bool update(Pose pose, float dt, float leftVelocity, float rightVelocity);
+  /**
+   * @brief Get the output for the left side of the drivetrain
+   *
+   * @return float power out of 127
+   */
+  float getLeftPower();
+  /**
+   * @brief Get the output for the right side of the drivetrain
+   *
+   * @return float power out of 127
+   */
+  float getRightPower();
+ private:
+  std::vector<Pose> path;
+  std::vector<float> curvatures;  // curvature of each point of the path, for the adaptive lookahead
+  Drivetrain_t drivetrain;
+  FollowSettings_t followSettings;
+  VelocityController_t velocitySettings;
+  float lookahead;
+  bool adaptive;
+  bool reverse;
+  float maxSpeed;
+  Pose prevPose = Pose(0, 0, 0);
+  Pose lastLookahead = Pose(0, 0, 0);
+  bool started = false;
+  float velocity = 0;  // filtered speed of the robot, in inches per second
+  float prevLeftVel = 0;
+  float prevRightVel = 0;
+  float leftPower = 0;
+  float rightPower = 0;
+};
+
+/**
+ * @brief RAMSETE trajectory follower, used by Chassis::ramsete()
+ */
+class Ramsete {
+ public:
+  /**
+   * @brief Construct a new Ramsete follower
+   *
+   * @param trajectory the trajectory, from timeParameterize()
+   * @param drivetrain the drivetrain
+   * @param followSettings the follow settings. The RAMSETE gains default to b = 0.0013 and zeta = 0.7 if they are 0
+   * @param velocitySettings the wheel velocity constants. Velocities are scaled to power if kV is 0
+   * @param reverse whether the robot follows the path in reverse
+   * @param maxSpeed the maximum speed the robot can move at
+   * @param endTolerance how far along the path from its last point the robot can stop, in inches
+   */
+  Ramsete(const std::vector<TrajectoryPoint_t>& trajectory, Drivetrain_t drivetrain, FollowSettings_t followSettings,
+          VelocityController_t velocitySettings, bool reverse, float maxSpeed, float endTolerance);
+  /**
+   * @brief Update the follower
+   *
+   * Once the trajectory is done, the follower keeps driving the robot to its last point until the robot is within
+   * the end tolerance
+   *
+   * @param pose the pose of the robot, with theta in radians
+   * @param time time since the start of the trajectory, in seconds
+   * @param leftVelocity measured velocity of the left wheels, in inches per second. Only used by the wheel velocity
+   * controller if its kP is not 0
+   * @param rightVelocity measured velocity of the right wheels, in inches per second
+   * @return true - the robot is following the trajectory, drive the motors with getLeftPower() and getRightPower()
+   * @return false - the trajectory is done, and the robot is within the end tolerance of its last point
+   */
+  bool update(Pose pose, float time, float leftVelocity, float rightVelocity);
+  /**
+   * @brief Get the output for the left side of the drivetrain
+   *
+   * @return float power out of 127
+   */
+  float getLeftPower();
+  /**
+   * @brief Get the output for the right side of the drivetrain
+   *
+   * @return float power out of 127
+   */
+  float getRightPower();
+ private:
+  std::vector<TrajectoryPoint_t> trajectory;
+  Drivetrain_t drivetrain;
+  VelocityController_t velocitySettings;
+  float b;
+  float zeta;
+  bool reverse;
+  float maxSpeed;
+  float endTolerance;
+  int index = 0;
+  float prevTime = 0;  // time of the last update, in seconds
+  float prevLeftVel = 0;
+  float prevRightVel = 0;
+  float leftPower = 0;
+  float rightPower = 0;
+};
+}  // namespace lemlib
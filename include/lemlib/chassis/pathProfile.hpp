@@ -0,0 +1,94 @@
+/**
+ * @file include/lemlib/chassis/pathProfile.hpp
+ * @author LemLib Team
+ * @brief Velocity profiling for paths followed by the chassis
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+/**
+ * @brief Struct containing a point on a time-parameterized trajectory
+ *
+ * @param x x position in inches
+ * @param y y position in inches
+ * @param theta heading in radians
+ * @param velocity linear velocity in inches per second
+ * @param angularVelocity angular velocity in radians per second, positive clockwise like theta
+ * @param time time since the start of the trajectory in seconds
+ */
+typedef struct {
+  float x;
+  float y;
+  float theta;
+  float velocity;
+  float angularVelocity;
+  float time;
+} TrajectoryPoint_t;
+
+/**
+ * @brief Get a path from the sd card
+ *
+ * @param filePath The file to read from
+ * @return std::vector<lemlib::Pose> vector of points on the path. theta is the velocity at that point
+ */
+std::vector<Pose> getData(std::string filePath);
+
+/**
+ * @brief Get the maximum velocity of the drivetrain
+ *
+ * @param drivetrain the drivetrain
+ * @return float maximum velocity in inches per second. Theoretical maximum if maxVelocity is not set
+ */
+float maxVelocity(Drivetrain_t drivetrain);
+
+/**
+ * @brief Get the curvature of the path at a point
+ *
+ * The curvature is the inverse of the radius of the circle passing through the point and its neighbours.
+ * The first and last points of the path have a curvature of 0
+ *
+ * @param path the path
+ * @param index index of the point
+ * @return float curvature in 1/inches, always positive
+ */
+float pathCurvature(const std::vector<Pose>& path, int index);
+
+/**
+ * @brief Generate the velocity profile of a path
+ *
+ * The theta value of each point is replaced by the target velocity at that point, in inches per second.
+ * Velocities read from the path file are treated as motor power (out of 127) and converted.
+ *
+ * If the drivetrain has no acceleration, deceleration or lateral acceleration limits, the velocities from the
+ * file are kept. Otherwise each point is limited by the maximum velocity, the curvature of the path, and then
+ * a forward (acceleration) and backward (deceleration) pass over the path. The last point always has a velocity
+ * of 0, which marks the end of the path.
+ *
+ * @param path the path to profile
+ * @param drivetrain the drivetrain constraints to respect
+ */
+void profilePath(std::vector<Pose>& path, Drivetrain_t drivetrain);
+
+/**
+ * @brief Time-parameterize a profiled path
+ *
+ * The heading at each point is the direction of the path, and the time to travel between points assumes
+ * constant acceleration between their profiled velocities
+ *
+ * @param path the profiled path
+ * @return std::vector<TrajectoryPoint_t> the trajectory
+ */
+std::vector<TrajectoryPoint_t> timeParameterize(std::vector<Pose>& path);
+}  // namespace lemlib
@@ -0,0 +1,71 @@
+/**
+ * @file include/lemlib/chassis/wheelController.hpp
+ * @author LemLib Team
+ * @brief Wheel velocity controller declarations
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "lemlib/chassis/chassis.hpp"
+#include "pros/motors.hpp"
+
+namespace lemlib {
+/**
+ * @brief Velocity controller for one side of the drivetrain
+ *
+ * Converts a target wheel velocity into motor power using kS/kV/kA feedforward,
+ * plus proportional feedback on the velocity measured by the motors. This keeps the wheel speed
+ * consistent as the battery drains or the load changes.
+ * The controller does not loop on its own. It must be called in a loop.
+ */
+class WheelController {
+ public:
+  /**
+   * @brief Construct a new Wheel Controller
+   *
+   * @param constants the feedforward and feedback constants
+   * @param motors the motor group driving the wheels
+   * @param wheelDiameter the diameter of the wheels in inches
+   * @param rpm the rpm of the wheels
+   */
+  WheelController(VelocityController_t constants, pros::Motor_Group* motors, float wheelDiameter, float rpm);
+  /**
+   * @brief Get the velocity of the wheels, measured by the motors
+   *
+   * @return float velocity in inches per second
+   */
+  float getVelocity();
+  /**
+   * @brief Update the controller
+   *
+   * @param targetVelocity the target wheel velocity in inches per second
+   * @param targetAcceleration the target wheel acceleration in inches per second squared
+   * @return float - power to send to the motors, out of 127
+   */
+  float update(float targetVelocity, float targetAcceleration);
+  /**
+   * @brief Drive the wheels at a velocity with the velocity controllers built into the motors
+   *
+   * @param velocity the target wheel velocity in inches per second
+   */
+  void moveVelocity(float velocity);
+ private:
+  /**
+   * @brief Get the rpm of the cartridge of a motor
+   *
+   * @param motor the motor
+   * @return float rpm of the cartridge
+   */
+  static float cartridgeRpm(pros::Motor& motor);
+
+  VelocityController_t constants;
+  pros::Motor_Group* motors;
+  float wheelDiameter;
+  float rpm;
+};
+}  // namespace lemlib
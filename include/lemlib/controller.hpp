@@ -0,0 +1,192 @@
+/**
+ * @file include/lemlib/controller.hpp
+ * @author LemLib Team
+ * @brief Header only controller built from compile time terms
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <math.h>
+
+#include <type_traits>
+
+namespace lemlib {
+/**
+ * @brief Struct containing the inputs of a controller update
+ *
+ * @param target the target value
+ * @param position the current value
+ * @param error target - position
+ * @param dt time since the last update, in seconds
+ * @param ticks time since the last update, in 10 ms loop periods. Gains are tuned per loop period, like FAPID
+ */
+typedef struct {
+  float target;
+  float position;
+  float error;
+  float dt;
+  float ticks;
+} ControllerInput_t;
+
+/**
+ * @brief Feedforward term, kF * target
+ */
+struct FeedforwardTerm {
+  float kF = 0;
+  float update(float output, const ControllerInput_t& input) { return output + kF * input.target; }
+  void reset() {}
+};
+
+/**
+ * @brief Proportional term, kP * error
+ */
+struct ProportionalTerm {
+  float kP = 0;
+  float update(float output, const ControllerInput_t& input) { return output + kP * input.error; }
+  void reset() {}
+};
+
+/**
+ * @brief Integral term, kI * total error
+ *
+ * @tparam ResetOnSignChange whether to reset the integral when the error changes sign
+ */
+template <bool ResetOnSignChange = false> struct IntegralTerm {
+  float kI = 0;
+  float limit = 0;  // the maximum output of the term. 0 to disable
+  float totalError = 0;
+  float prevError = 0;
+
+  float update(float output, const ControllerInput_t& input) {
+    if constexpr (ResetOnSignChange) {
+      if ((input.error > 0) != (prevError > 0)) totalError = 0;
+      prevError = input.error;
+    }
+    totalError += input.error * input.ticks;
+    float term = kI * totalError;
+    // anti-windup, stop integrating once the term reaches its limit
+    if (limit != 0 && std::fabs(term) > limit) {
+      term = (term > 0) ? limit : -limit;
+      totalError = term / kI;
+    }
+    return output + term;
+  }
+
+  void reset() {
+    totalError = 0;
+    prevError = 0;
+  }
+};
+
+/**
+ * @brief Derivative term, kD * change in error per loop period
+ *
+ * @tparam OnMeasurement whether to take the derivative of the measurement instead of the error, which avoids a
+ * spike in the output when the target changes
+ * @tparam Filtered whether to low-pass filter the derivative, with a time constant of filterTime seconds
+ */
+template <bool OnMeasurement = false, bool Filtered = false> struct DerivativeTerm {
+  float kD = 0;
+  float filterTime = 0;
+  float prevValue = 0;
+  float derivative = 0;
+  bool updated = false;
+
+  float update(float output, const ControllerInput_t& input) {
+    float value = OnMeasurement ? -input.position : input.error;
+    // the first update has no previous value, so it has no derivative
+    float raw = updated ? (value - prevValue) / input.ticks : 0;
+    if constexpr (Filtered) {
+      derivative += (raw - derivative) * input.dt / (filterTime + input.dt);
+    } else {
+      derivative = raw;
+    }
+    prevValue = value;
+    updated = true;
+    return output + kD * derivative;
+  }
+
+  void reset() {
+    prevValue = 0;
+    derivative = 0;
+    updated = false;
+  }
+};
+
+/**
+ * @brief Limits the change in output to kA per loop period. Put it after the terms it limits
+ */
+struct SlewLimit {
+  float kA = 0;
+  float prevOutput = 0;
+
+  float update(float output, const ControllerInput_t& input) {
+    float maxChange = kA * input.ticks;
+    if (output > prevOutput + maxChange) output = prevOutput + maxChange;
+    else if (output < prevOutput - maxChange) output = prevOutput - maxChange;
+    prevOutput = output;
+    return output;
+  }
+
+  void reset() { prevOutput = 0; }
+};
+
+/**
+ * @brief Controller built from terms chosen at compile time
+ *
+ * Each term takes the output of the terms before it, in order, and returns the new output. Only the terms that are
+ * used are compiled in, so a controller pays nothing for the terms it does not have. The controller is trivially
+ * copyable if its terms are, and does not allocate memory.
+ * For example, a PD controller with a slew limit:
+ * Controller<ProportionalTerm, DerivativeTerm<>, SlewLimit> pid({10}, {30}, {20});
+ * float output = pid.update(target, position, 0.01);
+ *
+ * @tparam Terms the terms of the controller
+ */
+template <class... Terms> class Controller : public Terms... {
+ public:
+  /**
+   * @brief Construct a new Controller
+   *
+   * @param terms the terms, with their gains set
+   */
+  Controller(Terms... terms) : Terms(terms)... {}
+
+  /**
+   * @brief Update the controller
+   *
+   * @param target the target value
+   * @param position the current value
+   * @param dt time since the last update, in seconds. 10 ms is used if it is not positive
+   * @return float output
+   */
+  float update(float target, float position, float dt = 0.01) {
+    if (dt <= 0) dt = 0.01;
+    ControllerInput_t input = {target, position, target - position, dt, dt / 0.01f};
+    float output = 0;
+    ((output = Terms::update(output, input)), ...);
+    return output;
+  }
+
+  /**
+   * @brief Reset the state of every term
+   */
+  void reset() { (Terms::reset(), ...); }
+
+  /**
+   * @brief Get a term of the controller, to change its gains
+   *
+   * @tparam Term the term
+   * @return Term& the term
+   */
+  template <class Term> Term& get() { return static_cast<Term&>(*this); }
+};
+
+static_assert(std::is_trivially_copyable_v<Controller<ProportionalTerm, DerivativeTerm<>, SlewLimit>>,
+              "controllers have to stay trivially copyable");
+}  // namespace lemlib
@@ -0,0 +1,99 @@
+/**
+ * @file include/lemlib/gainMailbox.hpp
+ * @author LemLib Team
+ * @brief Lock-free mailbox for gains tuned from the terminal
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief Gains posted from the terminal, shared by every FAPID with the same name
+ *
+ * There must only be one writer. It makes the sequence number odd while it writes a gain and even once it is done,
+ * so readers can tell when the gains changed and read them without locking (a seqlock). Only uses atomics, so it
+ * builds on the host as well, see tools/mailboxCheck.cpp
+ */
+class GainMailbox {
+ public:
+  /**
+   * @brief Index of each gain
+   */
+  enum Gain { KF, KA, KP, KI, KD, GAINS };
+
+  char name[32] = "";
+  std::atomic<std::uint32_t> resets {0};  // incremented to reset every FAPID reading the mailbox
+  std::atomic<float> totalError {0};  // published by the last FAPID that read the mailbox
+
+  /**
+   * @brief Whether any gain has been posted
+   *
+   * @return true if a gain has been posted
+   */
+  bool posted() const { return sequence.load(std::memory_order_acquire) != 0; }
+
+  /**
+   * @brief Get a gain
+   *
+   * @param gain which gain
+   * @return float the value
+   */
+  float get(Gain gain) const { return gains[gain].load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Set a gain without posting it, so it can be read from the terminal before anything is posted
+   *
+   * @param gain which gain
+   * @param value the value
+   */
+  void show(Gain gain, float value) {
+    if (!posted()) gains[gain].store(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Post a gain. Must only be called by the writer
+   *
+   * @param gain which gain
+   * @param value the value
+   */
+  void post(Gain gain, float value) {
+    std::uint32_t current = sequence.load(std::memory_order_relaxed);
+    sequence.store(current + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    gains[gain].store(value, std::memory_order_relaxed);
+    sequence.store(current + 2, std::memory_order_release);
+  }
+
+  /**
+   * @brief Read the gains if they changed since they were last read
+   *
+   * Never waits. If the writer is busy, the gains are left for the next call
+   *
+   * @param seen sequence number of the last read, updated if the gains are read. Start with 0
+   * @param values output gains, indexed by Gain
+   * @return true if the gains changed and were read
+   */
+  bool receive(std::uint32_t& seen, float (&values)[GAINS]) const {
+    std::uint32_t current = sequence.load(std::memory_order_acquire);
+    // an odd sequence number means a gain is being written
+    if (current == seen || current % 2 != 0) return false;
+    for (int i = 0; i < GAINS; i++) values[i] = gains[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // only use the gains if they were not changed while they were read
+    if (sequence.load(std::memory_order_relaxed) != current) return false;
+    seen = current;
+    return true;
+  }
+ private:
+  std::atomic<std::uint32_t> sequence {0};
+  std::atomic<float> gains[GAINS] = {};
+};
+}  // namespace lemlib
@@ -0,0 +1,73 @@
+/**
+ * @file include/lemlib/gainSchedule.hpp
+ * @author LemLib Team
+ * @brief Gain schedule declarations
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief Struct containing the gains of a point in a gain schedule
+ *
+ * @param kP proportional gain
+ * @param kD derivative gain
+ */
+typedef struct {
+  float kP;
+  float kD;
+} Gains_t;
+
+/**
+ * @brief Table of gains, keyed on the magnitude of the error and the battery voltage
+ *
+ * The points of the table are evenly spaced, so looking up the gains takes the same time no matter the size of the
+ * table. Gains between the points are interpolated, and errors or voltages outside of the table use the closest
+ * points
+ */
+class GainSchedule {
+ public:
+  /**
+   * @brief Construct a new Gain Schedule
+   *
+   * @param errorStep the difference in error between the columns of the table. The first column is an error of 0
+   * @param minVoltage the battery voltage of the first row of the table, in volts
+   * @param voltageStep the difference in battery voltage between the rows of the table, in volts
+   * @param table the gains, one row per battery voltage, each with one column per error. All rows must have the
+   * same number of columns. With a single row the battery voltage is ignored
+   */
+  GainSchedule(float errorStep, float minVoltage, float voltageStep, std::vector<std::vector<Gains_t>> table);
+  /**
+   * @brief Get the gains for an error and battery voltage
+   *
+   * @param error the error. Only the magnitude is used
+   * @param voltage the battery voltage, in volts
+   * @return Gains_t the interpolated gains
+   */
+  Gains_t get(float error, float voltage);
+ private:
+  /**
+   * @brief Find the index of the point below a value, and how far the value is towards the next point
+   *
+   * @param position the value in units of the spacing between the points
+   * @param size number of points
+   * @param index output index of the point below the value
+   * @param t output fraction of the way to the next point
+   */
+  static void locate(float position, int size, int& index, float& t);
+
+  float errorStep;
+  float minVoltage;
+  float voltageStep;
+  int rows;
+  int columns;
+  std::vector<Gains_t> table;  // row major, so the columns of a row are next to each other in memory
+};
+}  // namespace lemlib
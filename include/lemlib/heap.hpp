@@ -0,0 +1,84 @@
+/**
+ * @file include/lemlib/heap.hpp
+ * @author LemLib Team
+ * @brief Heap allocation tracking, and a guard that reports allocations after initialization
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace lemlib {
+namespace heap {
+/**
+ * @brief Competition phases allocations are counted in
+ */
+enum class Phase { INITIALIZE, DISABLED, AUTONOMOUS, OPCONTROL };
+
+/**
+ * @brief Maximum number of tasks allocations are counted for. Allocations from other tasks are counted in the last one
+ */
+constexpr int MAX_TASKS = 16;
+
+/**
+ * @brief Number of allocations the guard keeps the details of
+ */
+constexpr int MAX_VIOLATIONS = 16;
+
+/**
+ * @brief Struct containing the allocations made in a phase
+ *
+ * @param allocations number of allocations
+ * @param bytes number of bytes allocated
+ */
+typedef struct {
+  std::uint32_t allocations;
+  std::uint32_t bytes;
+} AllocationStats_t;
+
+/**
+ * @brief Mark the end of initialize()
+ *
+ * Allocations before this are counted in the INITIALIZE phase. After this, they are counted in the competition
+ * mode the robot is in, and reported by the guard if it is enabled
+ */
+void finishInitialize();
+
+/**
+ * @brief Enable or disable the guard
+ *
+ * While the guard is enabled, every allocation made after finishInitialize() is a violation. The first
+ * MAX_VIOLATIONS are kept with their size, task and time, and printed by print(). Allocations are not blocked
+ *
+ * @param enabled whether the guard is enabled
+ */
+void setGuard(bool enabled);
+
+/**
+ * @brief Get the allocations made in a phase
+ *
+ * @param phase the phase
+ * @return AllocationStats_t the allocations
+ */
+AllocationStats_t getStats(Phase phase);
+
+/**
+ * @brief Get the number of allocations reported by the guard
+ *
+ * @return std::uint32_t the number of violations
+ */
+std::uint32_t getViolations();
+
+/**
+ * @brief Print the allocations of each phase and task, the size of the heap and the violations of the guard
+ *
+ * Printing allocates, so call this while the robot is disabled
+ */
+void print();
+}  // namespace heap
+}  // namespace lemlib
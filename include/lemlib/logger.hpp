@@ -11,10 +11,23 @@
 
 #pragma once
 
+#include <cstdint>
+
+/**
+ * @brief The lowest level that is compiled in, as the ordinal of lemlib::logger::Level
+ *
+ * Calls to debug(), info(), warn(), error() and fatal() below this level compile to nothing.
+ * For example, add -DLEMLIB_MIN_LOG_LEVEL=2 to EXTRA_CXXFLAGS in the Makefile to remove DEBUG and INFO messages
+ */
+#ifndef LEMLIB_MIN_LOG_LEVEL
+#define LEMLIB_MIN_LOG_LEVEL 0
+#endif
+
 namespace lemlib {
 
-static bool debug = false;
-static bool verbose = false;
+// defined once in loggerConfig.cpp, so every file shares the same configuration
+extern bool debug;
+extern bool verbose;
 
 namespace logger {
 
@@ -31,7 +44,12 @@ namespace logger {
  */
 enum class Level { DEBUG, INFO, WARN, ERROR, FATAL };
 
-static Level lowestLevel = Level::INFO;
+extern Level lowestLevel;
+
+/**
+ * @brief The lowest level that is compiled in. Set with LEMLIB_MIN_LOG_LEVEL
+ */
+constexpr Level MIN_LEVEL = static_cast<Level>(LEMLIB_MIN_LOG_LEVEL);
 
 /**
  * @brief Whether or not to log debug messages.
@@ -74,6 +92,16 @@ Level getLowestLevel();
  */
 void setLowestLevel(Level level);
 
+/**
+ * @brief Get the number of messages dropped because the log buffer was full
+ *
+ * Messages are formatted into a fixed size buffer and printed by a low priority task, so logging never waits on
+ * the terminal. If messages are logged faster than they can be printed, the newest ones are dropped
+ *
+ * @return the number of dropped messages
+ */
+uint32_t getDropped();
+
 /**
  * @brief Logs a message with an exception
  *
@@ -95,45 +123,59 @@ void log(Level level, const char* message);
  *
  * @param message
  */
-void debug(const char* message);
+inline void debug(const char* message) {
+    if constexpr (MIN_LEVEL <= Level::DEBUG) log(Level::DEBUG, message);
+}
 /**
  * @brief Logs an info message
  *
  * @param message
  */
-void info(const char* message);
+inline void info(const char* message) {
+    if constexpr (MIN_LEVEL <= Level::INFO) log(Level::INFO, message);
+}
 /**
  * @brief Logs a warning message
  *
  * @param message
  */
-void warn(const char* message);
+inline void warn(const char* message) {
+    if constexpr (MIN_LEVEL <= Level::WARN) log(Level::WARN, message);
+}
 /**
  * @brief Logs an error message
  *
  * @param message
  * @param exception
  */
-void error(const char* message, const char* exception);
+inline void error(const char* message, const char* exception) {
+    if constexpr (MIN_LEVEL <= Level::ERROR) log(Level::ERROR, message, exception);
+}
 /**
  * @brief Logs an error message
  *
  * @param message
  */
-void error(const char* message);
+inline void error(const char* message) {
+    if constexpr (MIN_LEVEL <= Level::ERROR) log(Level::ERROR, message);
+}
 /**
  * @brief Logs a fatal message
  *
  * @param message
  * @param exception
  */
-void fatal(const char* message, const char* exception);
+inline void fatal(const char* message, const char* exception) {
+    if constexpr (MIN_LEVEL <= Level::FATAL) log(Level::FATAL, message, exception);
+}
 /**
  * @brief Logs a fatal message
  *
  * @param message
  */
-void fatal(const char* message);
+inline void fatal(const char* message) {
+    if constexpr (MIN_LEVEL <= Level::FATAL) log(Level::FATAL, message);
+}
 
 } // namespace logger
 } // namespace lemlib
\ No newline at end of file
@@ -0,0 +1,97 @@
+/**
+ * @file include/lemlib/monitor.hpp
+ * @author LemLib Team
+ * @brief Task monitor, measures the period, CPU use and free stack of control loops
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace lemlib {
+namespace monitor {
+/**
+ * @brief Maximum number of monitored loops
+ */
+constexpr int MAX_LOOPS = 8;
+
+/**
+ * @brief Number of bins in the period histogram. Each bin is 1 ms wide, and the last bin counts every longer period
+ */
+constexpr int HISTOGRAM_BINS = 20;
+
+/**
+ * @brief Struct containing the statistics of a loop
+ *
+ * @param name name of the loop
+ * @param period target period of the loop, in milliseconds
+ * @param meanPeriod mean period over the last second, in milliseconds
+ * @param maxPeriod longest period over the last second, in milliseconds
+ * @param cpu fraction of the time the loop was running over the last second, from 0 to 1
+ * @param freeStack least free stack the task of the loop has ever had, in words. -1 if it is unavailable
+ * @param histogram number of periods in each 1 ms bin, since the loop was added
+ */
+typedef struct {
+  const char* name;
+  int period;
+  float meanPeriod;
+  float maxPeriod;
+  float cpu;
+  int freeStack;
+  std::uint32_t histogram[HISTOGRAM_BINS];
+} LoopStats_t;
+
+/**
+ * @brief Add a loop to monitor
+ *
+ * The loop calls beginLoop() at the start of every iteration and endLoop() before it waits for the next one.
+ * A telemetry channel (see channels.hpp) named after the loop is added, with the mean period, longest period,
+ * CPU use and free stack
+ *
+ * @param name name of the loop. Must be a string literal
+ * @param period target period of the loop, in milliseconds
+ * @return int id of the loop, -1 if there is no room for it
+ */
+int addLoop(const char* name, int period);
+
+/**
+ * @brief Mark the start of an iteration of a loop
+ *
+ * @param id id of the loop. Ignored if it is -1
+ */
+void beginLoop(int id);
+
+/**
+ * @brief Mark the end of the work of an iteration of a loop
+ *
+ * @param id id of the loop. Ignored if it is -1
+ */
+void endLoop(int id);
+
+/**
+ * @brief Get the statistics of a loop
+ *
+ * @param id id of the loop
+ * @return LoopStats_t the statistics
+ */
+LoopStats_t getStats(int id);
+
+/**
+ * @brief Start the monitor task, which updates the statistics every second
+ *
+ * @param screen whether to show the statistics on the brain screen. false by default
+ * @param firstLine first line of the brain screen to use, one line per loop. 5 by default, below the auton selector
+ */
+void start(bool screen = false, int firstLine = 5);
+
+/**
+ * @brief Print the period histogram of every loop to the terminal
+ */
+void print();
+}  // namespace monitor
+}  // namespace lemlib
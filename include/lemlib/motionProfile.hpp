@@ -0,0 +1,92 @@
+/**
+ * @file include/lemlib/motionProfile.hpp
+ * @author LemLib Team
+ * @brief Trapezoidal and S-curve motion profile declarations
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+namespace lemlib {
+/**
+ * @brief Point to point motion profile
+ *
+ * The profile starts and ends at rest. It is trapezoidal if the jerk is 0, and a jerk limited S-curve otherwise.
+ * The whole profile is calculated when it is constructed, so its duration is known before the motion starts.
+ * Units are up to the user, as long as they are consistent (inches or degrees, and seconds)
+ */
+class MotionProfile {
+ public:
+  /**
+   * @brief Construct a new Motion Profile
+   *
+   * @param distance the distance to travel. Can be negative
+   * @param maxVelocity the maximum velocity
+   * @param maxAcceleration the maximum acceleration and deceleration
+   * @param maxJerk the maximum jerk. Trapezoidal profile if set to 0
+   */
+  MotionProfile(float distance, float maxVelocity, float maxAcceleration, float maxJerk = 0);
+  /**
+   * @brief Get the duration of the profile
+   *
+   * @return float duration in seconds
+   */
+  float getDuration();
+  /**
+   * @brief Get the position along the profile
+   *
+   * @param time time since the start of the profile, in seconds
+   * @return float position
+   */
+  float getPosition(float time);
+  /**
+   * @brief Get the velocity along the profile
+   *
+   * @param time time since the start of the profile, in seconds
+   * @return float velocity
+   */
+  float getVelocity(float time);
+  /**
+   * @brief Get the acceleration along the profile
+   *
+   * @param time time since the start of the profile, in seconds
+   * @return float acceleration
+   */
+  float getAcceleration(float time);
+ private:
+  /**
+   * @brief Sample the acceleration phase of the profile
+   *
+   * The deceleration phase is the acceleration phase mirrored in time
+   *
+   * @param time time since the start of the acceleration phase
+   * @param position output position
+   * @param velocity output velocity
+   * @param acceleration output acceleration
+   */
+  void sampleAccel(float time, float& position, float& velocity, float& acceleration);
+  /**
+   * @brief Sample the profile
+   *
+   * @param time time since the start of the profile, in seconds
+   * @param position output position
+   * @param velocity output velocity
+   * @param acceleration output acceleration
+   */
+  void sample(float time, float& position, float& velocity, float& acceleration);
+
+  float direction;
+  float distance;
+  float velocity;      // cruise velocity
+  float acceleration;  // peak acceleration
+  float jerk;
+  float jerkTime;    // time spent ramping the acceleration up or down
+  float accelTime;   // time spent at constant acceleration
+  float rampTime;    // total time to accelerate to the cruise velocity
+  float cruiseTime;  // time spent at the cruise velocity
+};
+}  // namespace lemlib
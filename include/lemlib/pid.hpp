@@ -9,7 +9,10 @@
  *
  */
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include "lemlib/gainMailbox.hpp"
 #include "pros/rtos.hpp"
 
 namespace lemlib {
@@ -22,6 +25,11 @@ namespace lemlib {
  */
 class FAPID {
     public:
+        /**
+         * @brief The exit condition that settled the FAPID
+         *
+         */
+        enum class Exit { NONE, TIMEOUT, LARGE_ERROR, SMALL_ERROR, STOPPED };
         /**
          * @brief Construct a new FAPID
          *
@@ -30,7 +38,7 @@ class FAPID {
          * @param kP proportional gain, multiplied by error and added to output
          * @param kI integral gain, multiplied by total error and added to output
          * @param kD derivative gain, multiplied by change in error and added to output
-         * @param name name of the FAPID. Used for logging
+         * @param name name of the FAPID. Used for logging, FAPIDs with the same name share their tuned gains
          */
         FAPID(float kF, float kA, float kP, float kI, float kD, std::string name);
         /**
@@ -54,15 +62,57 @@ class FAPID {
          */
         void setExit(float largeError, float smallError, int largeTime, int smallTime, int maxTime);
         /**
-         * @brief Update the FAPID
+         * @brief Set the stopped exit condition
+         *
+         * The FAPID settles once the error is within the settle error and both the rate of change of the error and
+         * the measured velocity are within the settle velocity for the settle time. This exits a motion as soon as
+         * the robot has stopped close enough to the target, instead of waiting for the small or large error timeout
+         *
+         * @param settleError range where the error is considered settled. Set 0 to disable
+         * @param settleVelocity range where the velocity is considered stopped, in units of the error per second
+         * @param settleTime time in milliseconds the robot has to stay stopped. Can be 0
+         */
+        void setSettle(float settleError, float settleVelocity, int settleTime);
+        /**
+         * @brief Set the derivative mode
+         *
+         * Taking the derivative of the measurement instead of the error avoids a spike in the output when the
+         * target changes. The low-pass filter smooths out sensor noise, at the cost of some delay
+         *
+         * @param onMeasurement whether to take the derivative of the measurement instead of the error
+         * @param filterTime time constant of the low-pass filter on the derivative, in seconds. 0 to disable
+         */
+        void setDerivative(bool onMeasurement, float filterTime = 0);
+        /**
+         * @brief Set the integral anti-windup
+         *
+         * @param integralLimit the maximum output of the integral term. 0 to disable
+         * @param resetOnSignChange whether to reset the integral when the error changes sign
+         */
+        void setIntegral(float integralLimit, bool resetOnSignChange = false);
+        /**
+         * @brief Update the FAPID, measuring the time since the last update
          *
          * @param target the target value
          * @param position the current value
-         * @param log whether to check the most recent terminal input for user input. Default is false because logging
-         * multiple PIDs could slow down the program.
+         * @param log whether to check for gains posted from the terminal. Default is false
          * @return float - output
          */
         float update(float target, float position, bool log = false);
+        /**
+         * @brief Update the FAPID with a known time since the last update
+         *
+         * The gains are tuned for a loop running every 10 ms. The integral, derivative and acceleration terms are
+         * scaled by the time since the last update, so the controller behaves the same at other rates and when the
+         * loop is late. This function does not allocate memory
+         *
+         * @param target the target value
+         * @param position the current value
+         * @param dt time since the last update, in seconds
+         * @param log whether to check for gains posted from the terminal. Default is false
+         * @return float - output
+         */
+        float updateDt(float target, float position, float dt, bool log = false);
         /**
          * @brief Reset the FAPID
          */
@@ -72,27 +122,57 @@ class FAPID {
          *
          * If the exit conditions have not been set, this function will always return false
          *
+         * @param velocity the measured velocity, in units of the error per second. Used by the stopped exit
+         * condition, along with the rate of change of the error. 0 by default
          * @return true - the FAPID has settled
          * @return false - the FAPID has not settled
          */
-        bool settled();
+        bool settled(float velocity = 0);
+        /**
+         * @brief Get the exit condition that settled the FAPID
+         *
+         * @return Exit - the exit condition, NONE if the FAPID has not settled
+         */
+        Exit getExit();
+        /**
+         * @brief Get the time spent settling
+         *
+         * This is the time since the error first came within the large error (or settle error) range, until the
+         * FAPID settled, or until now if it has not settled yet
+         *
+         * @return int - time in milliseconds, 0 if the error never came within range
+         */
+        int getSettleTime();
+        /**
+         * @brief Check if the FAPID uses gains posted from the terminal
+         *
+         * This is true once an update with log set to true has picked up posted gains. Gain schedules leave these
+         * gains alone, so they can be tuned live
+         *
+         * @return true - the FAPID uses posted gains
+         * @return false - the FAPID uses the gains set in code
+         */
+        bool hasPostedGains();
         /**
          * @brief initialize the FAPID logging system
          *
-         * if this function is called, std::cin will be used to interact with the FAPID
+         * if this function is called, a task reads std::cin so the user can interact with the FAPID through the
+         * terminal. New gains are posted to the FAPIDs without locking, and are picked up on their next update if
+         * it is called with log set to true. Gains posted to a name are kept for every FAPID created with that name
+         * afterwards, until the program restarts
          *
-         * the user can interact with the FAPID through the terminal
-         * the user can access gains and other variables with the following format:
+         * the user can access gains with the following format:
          * <name>.<variable> to get the value of the variable
          * <name>.<variable>_<value> to set the value of the variable
          * for example:
          * pid.kP_0.5 will set the kP value to 0.5
-         * list of variables thats value can be set:
+         * list of variables thats value can be set and accessed:
          * kF, kA, kP, kI, kD
          * list of variables that can be accessed:
-         * kF, kA, kP, kI, kD, totalError
+         * totalError, as of the last update of a FAPID with that name and log set to true
          * list of functions that can be called:
          * reset()
+         * the commands are checked on the host by tools/pidCommandCheck.cpp
          */
         static void init();
     private:
@@ -108,17 +188,60 @@ class FAPID {
         int smallTime = 0;
         int maxTime = -1; // -1 means no max time set, run forever
 
+        float settleError = 0;
+        float settleVelocity = 0;
+        int settleTime = 0;
+
         int largeTimeCounter = 0;
         int smallTimeCounter = 0;
+        int settleTimeCounter = 0;
         int startTime = 0;
+        int settleStartTime = 0;
+        int exitTime = 0;
+        Exit exit = Exit::NONE;
 
         float prevError = 0;
         float totalError = 0;
         float prevOutput = 0;
+        float errorRate = 0; // rate of change of the error, per second
+        float prevPosition = 0;
+        float prevDerivative = 0;
+        uint64_t prevMicros = 0;
+        bool updated = false; // whether the FAPID has been updated since it was reset
+
+        bool derivativeOnMeasurement = false;
+        float derivativeFilterTime = 0;
+        float integralLimit = 0;
+        bool integralResetOnSignChange = false;
+
+        static constexpr float NOMINAL_DT = 0.01; // the loop period the gains are tuned for, in seconds
+
+        static constexpr int MAX_MAILBOXES = 16;
+
+        /**
+         * @brief Pick up gains and resets posted to the mailbox
+         */
+        void receive();
+        /**
+         * @brief Find the mailbox of a name. The logging mutex must be held
+         *
+         * @param name name of the FAPID
+         * @param create whether to create the mailbox if it does not exist
+         * @return GainMailbox* - the mailbox, nullptr if it does not exist or there is no room for it
+         */
+        static GainMailbox* findMailbox(const std::string& name, bool create);
+        /**
+         * @brief Run a command from the terminal
+         *
+         * @param input the command
+         */
+        static void command(const std::string& input);
 
-        void log();
         std::string name;
-        static std::string input;
+        GainMailbox* mailbox = nullptr;
+        uint32_t seenSequence = 0;
+        uint32_t seenResets = 0;
+        static GainMailbox mailboxes[MAX_MAILBOXES];
         static pros::Task* logTask;
         static pros::Mutex logMutex;
 };
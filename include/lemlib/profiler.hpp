@@ -0,0 +1,132 @@
+/**
+ * @file include/lemlib/profiler.hpp
+ * @author LemLib Team
+ * @brief Scoped trace events, saved to the SD card and viewed as a Chrome trace
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace lemlib {
+namespace profiler {
+/**
+ * @brief Number of events kept in RAM. The oldest events are overwritten by new ones
+ */
+constexpr int MAX_EVENTS = 4096;
+
+/**
+ * @brief Start recording trace events
+ *
+ * Until this is called, begin() and end() return immediately
+ */
+void start();
+
+/**
+ * @brief Stop recording trace events
+ */
+void stop();
+
+/**
+ * @brief Record the start of a section
+ *
+ * @param name name of the section. Must be a string literal, the pointer is kept until the trace is saved
+ */
+void begin(const char* name);
+
+/**
+ * @brief Record the end of a section
+ *
+ * @param name name of the section. Must be the same string as the matching begin()
+ */
+void end(const char* name);
+
+/**
+ * @brief Save the recorded events to the SD card
+ *
+ * Recording is paused while the file is written, and resumes afterwards if it was running. The file can be
+ * converted to a Chrome trace (chrome://tracing or ui.perfetto.dev) with tools/traceConvert.cpp.
+ * Writing the file takes a while, so call this when the robot is disabled, not from a control loop
+ *
+ * @param path path of the file. No need to preface it with /usd/. "trace.bin" by default
+ * @return true the trace was saved
+ * @return false the file could not be created
+ */
+bool dump(const char* path = "trace.bin");
+
+/**
+ * @brief Records a section from construction to destruction
+ *
+ * @b Example
+ * @code {.cpp}
+ * while (true) {
+ *   lemlib::profiler::Scope scope("opcontrol");
+ *   // ...
+ *   pros::delay(10);
+ * }
+ * @endcode
+ */
+class Scope {
+ public:
+  /**
+   * @brief Record the start of a section
+   *
+   * @param name name of the section. Must be a string literal
+   */
+  explicit Scope(const char* name)
+      : name(name) {
+    begin(name);
+  }
+
+  /**
+   * @brief Record the end of the section
+   */
+  ~Scope() { end(name); }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+ private:
+  const char* name;
+};
+
+#pragma pack(push, 1)
+/**
+ * @brief Header at the start of a saved trace
+ *
+ * Followed by nameCount names and taskCount task names, each a length byte then the characters, then eventCount
+ * TraceRecord_t
+ *
+ * @param magic "LLTR"
+ * @param nameCount number of section names
+ * @param taskCount number of task names
+ * @param eventCount number of events
+ */
+typedef struct {
+  char magic[4];
+  std::uint16_t nameCount;
+  std::uint16_t taskCount;
+  std::uint32_t eventCount;
+} TraceHeader_t;
+
+/**
+ * @brief An event in a saved trace
+ *
+ * @param time time of the event, in microseconds. Wraps around every 71 minutes
+ * @param phase 'B' for the start of a section, 'E' for the end
+ * @param name index of the name of the section
+ * @param task index of the name of the task
+ */
+typedef struct {
+  std::uint32_t time;
+  char phase;
+  std::uint8_t name;
+  std::uint8_t task;
+} TraceRecord_t;
+#pragma pack(pop)
+}  // namespace profiler
+}  // namespace lemlib
@@ -0,0 +1,75 @@
+/**
+ * @file include/lemlib/taskTable.hpp
+ * @author LemLib Team
+ * @brief Lock-free table of task names, shared by the heap counters and the profiler
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+
+namespace lemlib {
+/**
+ * @brief A table giving each task a slot, found by the name of the task
+ *
+ * The name is copied while the task is running, since the task may be deleted before the table is printed. Tasks
+ * are identified by name, so every run of a task (like opcontrol) gets the same slot, and a new task that reuses the
+ * memory of a deleted one does not get the slot of the deleted one. Tasks claim a slot with a compare and swap, so
+ * finding a slot never waits on a lock and never allocates. The last slot is shared by the tasks that don't fit
+ *
+ * @tparam SLOTS number of slots, including the shared one
+ */
+template <int SLOTS> class TaskTable {
+ public:
+  /**
+   * @brief Find the slot of a task, claiming a free one if the task doesn't have one yet
+   *
+   * @param name name of the task. nullptr is the same as an empty name
+   * @return int index of the slot, SLOTS - 1 if the table is full
+   */
+  int find(const char* name) {
+    if (name == nullptr) name = "";
+    for (int i = 0; i < SLOTS - 1; i++) {
+      int state = slots[i].state.load(std::memory_order_acquire);
+      if (state == READY && std::strncmp(slots[i].name, name, sizeof(Slot::name) - 1) == 0) return i;
+      if (state == FREE) {
+        // claim the slot. A slot another task is claiming is skipped instead of waited on, so a task never waits on
+        // a lower priority one. At worst a task gets two slots
+        int expected = FREE;
+        if (!slots[i].state.compare_exchange_strong(expected, CLAIMED, std::memory_order_acquire)) continue;
+        std::strncpy(slots[i].name, name, sizeof(Slot::name) - 1);
+        slots[i].name[sizeof(Slot::name) - 1] = '\0';
+        slots[i].state.store(READY, std::memory_order_release);
+        return i;
+      }
+    }
+    return SLOTS - 1;
+  }
+
+  /**
+   * @brief Get the name of the task in a slot
+   *
+   * @param index index of the slot
+   * @return const char* name of the task, "other tasks" for the shared slot, empty if the slot is not ready
+   */
+  const char* getName(int index) const {
+    if (index == SLOTS - 1) return "other tasks";
+    return (slots[index].state.load(std::memory_order_acquire) == READY) ? slots[index].name : "";
+  }
+ private:
+  enum State { FREE, CLAIMED, READY };  // CLAIMED while the name is copied
+
+  struct Slot {
+    std::atomic<int> state {FREE};
+    char name[32];
+  };
+
+  Slot slots[SLOTS - 1];
+};
+}  // namespace lemlib
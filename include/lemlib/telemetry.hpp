@@ -0,0 +1,96 @@
+/**
+ * @file include/lemlib/telemetry.hpp
+ * @author LemLib Team
+ * @brief Binary telemetry over the serial terminal
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "lemlib/pose.hpp"
+#include "lemlib/telemetryFormat.hpp"
+#include "pros/motors.hpp"
+
+namespace lemlib {
+namespace telemetry {
+/**
+ * @brief Struct containing the cost of the telemetry sent so far
+ *
+ * @param records number of records sent
+ * @param bytes number of bytes sent
+ * @param micros time spent sending records, in microseconds
+ */
+typedef struct {
+  std::uint32_t records;
+  std::uint32_t bytes;
+  std::uint32_t micros;
+} TelemetryStats_t;
+
+/**
+ * @brief Start sending telemetry
+ *
+ * Records are sent as binary frames on the serial terminal (see telemetryFormat.hpp). Until this is called, the
+ * record functions do nothing. This switches the terminal to raw, non-blocking output, so capture it with a raw
+ * serial reader (for example: cat /dev/ttyACM1 > capture.bin) and decode it with tools/telemetryDecode.cpp.
+ * Text printed to the terminal is skipped by the decoder.
+ * Records are also kept by the black box recorder if it is running (see blackbox.hpp), even without init()
+ */
+void init();
+
+/**
+ * @brief Send the position of the robot
+ *
+ * @param pose the position, with theta in degrees
+ */
+void pose(const Pose& pose);
+
+/**
+ * @brief Send the voltage, velocity and current of a motor
+ *
+ * @param motor the motor
+ */
+void motor(pros::Motor& motor);
+
+/**
+ * @brief Send the voltage, velocity and current of every motor in a group
+ *
+ * @param motors the motor group
+ */
+void motors(pros::Motor_Group& motors);
+
+/**
+ * @brief Send the error and output of a controller
+ *
+ * @param id id of the controller, chosen by the user
+ * @param error the error of the controller
+ * @param output the output of the controller
+ */
+void controller(std::uint8_t id, float error, float output);
+
+/**
+ * @brief Send a record
+ *
+ * The record is framed and sent over the serial terminal if init() was called, and kept by the black box recorder
+ * if it is running
+ *
+ * @param type the type of the record
+ * @param payload the record
+ * @param length size of the record in bytes
+ */
+void send(RecordType type, const void* payload, std::uint8_t length);
+
+/**
+ * @brief Get the cost of the telemetry sent so far
+ *
+ * @return TelemetryStats_t bytes sent and time spent sending. Divide by the number of records (or loop iterations)
+ * for the bandwidth per record and the cost per tick
+ */
+TelemetryStats_t getStats();
+}  // namespace telemetry
+}  // namespace lemlib
@@ -0,0 +1,108 @@
+/**
+ * @file include/lemlib/telemetryFormat.hpp
+ * @author LemLib Team
+ * @brief Binary telemetry frame format, shared by the robot and the host decoder
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// This header must not depend on PROS, it is also compiled by the host decoder in tools/
+// Frames are little endian, which both the V5 brain and x86 hosts are:
+// sync (2 bytes) | type (1) | payload length (1) | time in ms (4) | payload | CRC-8 of everything but the sync
+
+namespace lemlib {
+namespace telemetry {
+constexpr std::uint8_t SYNC_1 = 0xAA;
+constexpr std::uint8_t SYNC_2 = 0x55;
+
+/**
+ * @brief Types of telemetry records
+ */
+enum class RecordType : std::uint8_t { POSE = 1, MOTOR = 2, CONTROLLER = 3, CHANNELS = 4, CHANNEL_NAME = 5 };
+
+#pragma pack(push, 1)
+/**
+ * @brief Header of a telemetry frame
+ */
+struct FrameHeader {
+  std::uint8_t sync[2];
+  std::uint8_t type;
+  std::uint8_t length;
+  std::uint32_t time;
+};
+
+/**
+ * @brief Position of the robot. x and y in inches, theta in degrees
+ */
+struct PoseRecord {
+  float x;
+  float y;
+  float theta;
+};
+
+/**
+ * @brief State of a motor. Voltage in millivolts, velocity in tenths of an rpm, current in milliamps
+ */
+struct MotorRecord {
+  std::uint8_t port;
+  std::int16_t voltage;
+  std::int16_t velocity;
+  std::int16_t current;
+};
+
+/**
+ * @brief Error and output of a controller. id is chosen by the user
+ */
+struct ControllerRecord {
+  std::uint8_t id;
+  float error;
+  float output;
+};
+
+/**
+ * @brief Start of a channel sample. A CHANNELS record is a list of samples, each followed by count floats
+ */
+struct ChannelSample {
+  std::uint8_t id;
+  std::uint8_t count;
+};
+
+/**
+ * @brief Start of a CHANNEL_NAME record, followed by the name of the channel (not null terminated)
+ */
+struct ChannelName {
+  std::uint8_t id;
+  std::uint8_t count;
+};
+#pragma pack(pop)
+
+/**
+ * @brief Size of a frame, without its payload
+ */
+constexpr std::size_t FRAME_OVERHEAD = sizeof(FrameHeader) + 1;
+
+/**
+ * @brief Calculate the CRC-8 (polynomial 0x07) of some data
+ *
+ * @param data the data
+ * @param length length of the data in bytes
+ * @param crc the CRC of the data before this data, to checksum data in pieces
+ * @return std::uint8_t the CRC
+ */
+inline std::uint8_t crc8(const std::uint8_t* data, std::size_t length, std::uint8_t crc = 0) {
+  for (std::size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+  }
+  return crc;
+}
+}  // namespace telemetry
+}  // namespace lemlib
@@ -0,0 +1,173 @@
+/**
+ * @file src/lemlib/blackbox.cpp
+ * @author LemLib Team
+ * @brief Black box recorder, keeps the latest telemetry in RAM and saves it to the SD card
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/blackbox.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+std::uint8_t buffer[lemlib::blackbox::BUFFER_SIZE];    // ring buffer of the latest telemetry
+std::uint8_t snapshot[lemlib::blackbox::BUFFER_SIZE];  // copy of the ring buffer that is being saved
+std::size_t writeIndex = 0;                             // where the next byte goes in the ring buffer
+bool wrapped = false;                                   // whether the ring buffer has been filled at least once
+std::atomic_flag busy = ATOMIC_FLAG_INIT;               // set while the ring buffer is written or copied
+std::atomic<bool> enabled {false};
+std::atomic<const char*> pendingReason {nullptr};
+std::atomic<std::uint32_t> dropped {0};
+std::uint32_t sequence = 0;  // only used by the recorder task
+
+/**
+ * @brief Get the file name of a recording
+ *
+ * @param name output file name
+ * @param length size of name
+ * @param sequence sequence number of the recording
+ */
+void fileName(char* name, std::size_t length, std::uint32_t sequence) {
+  snprintf(name, length, "/usd/blackbox%lu.bin", (unsigned long)(sequence % lemlib::blackbox::MAX_FILES));
+}
+
+/**
+ * @brief Find the sequence number of the newest recording on the SD card
+ *
+ * @return std::uint32_t the sequence number, 0 if there are no recordings
+ */
+std::uint32_t newestSequence() {
+  std::uint32_t newest = 0;
+  for (int i = 0; i < lemlib::blackbox::MAX_FILES; i++) {
+    char name[32];
+    fileName(name, sizeof(name), i);
+    FILE* file = fopen(name, "rb");
+    if (file == nullptr) continue;
+    lemlib::blackbox::BlackboxHeader_t header;
+    if (fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "LLBB", 4) == 0 &&
+        header.sequence > newest) {
+      newest = header.sequence;
+    }
+    fclose(file);
+  }
+  return newest;
+}
+
+/**
+ * @brief Copy the ring buffer and write it to the SD card
+ *
+ * @param reason why the recording is saved
+ */
+void save(const char* reason) {
+  // copy the ring buffer oldest byte first, so the control tasks can keep recording while the file is written
+  while (busy.test_and_set(std::memory_order_acquire)) pros::delay(1);
+  std::size_t size = wrapped ? lemlib::blackbox::BUFFER_SIZE : writeIndex;
+  std::size_t oldest = wrapped ? writeIndex : 0;
+  std::size_t firstPart = size - oldest;
+  std::memcpy(snapshot, buffer + oldest, firstPart);
+  std::memcpy(snapshot + firstPart, buffer, oldest);
+  busy.clear(std::memory_order_release);
+
+  // write to the next file in the rotation. Each recording is a complete file of its own, so a crash while
+  // writing can only lose the recording being written
+  sequence++;
+  char name[32];
+  fileName(name, sizeof(name), sequence);
+  FILE* file = fopen(name, "wb");
+  if (file == nullptr) return;  // no SD card
+  lemlib::blackbox::BlackboxHeader_t header = {{'L', 'L', 'B', 'B'}, sequence, pros::millis(), {}};
+  std::strncpy(header.reason, reason, sizeof(header.reason) - 1);
+  fwrite(&header, sizeof(header), 1, file);
+  // write in blocks, so other low priority tasks get to run between them
+  const std::size_t BLOCK = 4096;
+  for (std::size_t i = 0; i < size; i += BLOCK) {
+    fwrite(snapshot + i, 1, (size - i < BLOCK) ? size - i : BLOCK, file);
+    pros::delay(1);
+  }
+  fclose(file);
+}
+
+/**
+ * @brief Recorder task. Saves the recording when it is requested or the competition mode changes
+ */
+void recorder() {
+  sequence = newestSequence();
+  std::uint8_t prevStatus = pros::competition::get_status() & (COMPETITION_DISABLED | COMPETITION_AUTONOMOUS);
+  while (true) {
+    // a mode ends when the robot was enabled, and now it is disabled or in the other mode
+    std::uint8_t status = pros::competition::get_status() & (COMPETITION_DISABLED | COMPETITION_AUTONOMOUS);
+    if (status != prevStatus && !(prevStatus & COMPETITION_DISABLED)) {
+      save((prevStatus & COMPETITION_AUTONOMOUS) ? "autonomous end" : "opcontrol end");
+    }
+    prevStatus = status;
+
+    const char* reason = pendingReason.exchange(nullptr);
+    if (reason != nullptr) save(reason);
+    pros::delay(20);
+  }
+}
+}  // namespace
+
+/**
+ * @brief Start the black box recorder
+ */
+void lemlib::blackbox::init() {
+  if (enabled.exchange(true)) return;  // already started
+  pros::Task task(recorder, TASK_PRIORITY_MIN, TASK_STACK_DEPTH_DEFAULT, "LemLib black box");
+}
+
+/**
+ * @brief Whether the black box recorder has been started
+ *
+ * @return true if the recorder is running
+ */
+bool lemlib::blackbox::isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+/**
+ * @brief Add data to the recording
+ *
+ * @param data the data
+ * @param length length of the data in bytes
+ */
+void lemlib::blackbox::record(const void* data, std::size_t length) {
+  if (!isEnabled() || length > BUFFER_SIZE) return;
+  if (busy.test_and_set(std::memory_order_acquire)) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  // copy the data, wrapping around the end of the ring buffer
+  std::size_t firstPart = (length < BUFFER_SIZE - writeIndex) ? length : BUFFER_SIZE - writeIndex;
+  std::memcpy(buffer + writeIndex, data, firstPart);
+  std::memcpy(buffer, static_cast<const std::uint8_t*>(data) + firstPart, length - firstPart);
+  writeIndex += length;
+  if (writeIndex >= BUFFER_SIZE) {
+    writeIndex -= BUFFER_SIZE;
+    wrapped = true;
+  }
+  busy.clear(std::memory_order_release);
+}
+
+/**
+ * @brief Save the recording to the SD card
+ *
+ * @param reason why the recording is saved
+ */
+void lemlib::blackbox::dump(const char* reason) {
+  if (isEnabled()) pendingReason = reason;
+}
+
+/**
+ * @brief Get the number of times data was dropped because the recording was busy
+ *
+ * @return the number of dropped records
+ */
+std::uint32_t lemlib::blackbox::getDropped() { return dropped.load(std::memory_order_relaxed); }
@@ -0,0 +1,142 @@
+/**
+ * @file src/lemlib/channels.cpp
+ * @author LemLib Team
+ * @brief Telemetry channels, sampled at their own rates by one task
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/channels.hpp"
+
+#include <math.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "lemlib/telemetry.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+/**
+ * @brief A registered channel
+ */
+struct Channel {
+  char name[32];
+  int period;  // in ticks
+  int count;
+  std::function<void(float*)> getter;
+};
+
+Channel channels[lemlib::telemetry::MAX_CHANNELS];
+// channels are filled in before the count is increased, so the sampling task only sees complete channels
+std::atomic<int> channelCount {0};
+pros::Mutex channelMutex;
+std::atomic<bool> started {false};
+
+/**
+ * @brief Send the names of every channel
+ */
+void sendNames() {
+  int count = channelCount.load(std::memory_order_acquire);
+  for (int id = 0; id < count; id++) {
+    std::uint8_t payload[sizeof(lemlib::telemetry::ChannelName) + sizeof(Channel::name)];
+    lemlib::telemetry::ChannelName header = {static_cast<std::uint8_t>(id),
+                                             static_cast<std::uint8_t>(channels[id].count)};
+    std::size_t length = std::strlen(channels[id].name);
+    std::memcpy(payload, &header, sizeof(header));
+    std::memcpy(payload + sizeof(header), channels[id].name, length);
+    lemlib::telemetry::send(lemlib::telemetry::RecordType::CHANNEL_NAME, payload, sizeof(header) + length);
+  }
+}
+
+/**
+ * @brief Sample the channels that are due, and send them together
+ *
+ * @param tick number of ticks since the task started
+ */
+void sample(std::uint32_t tick) {
+  std::uint8_t payload[255];
+  std::size_t length = 0;
+  int count = channelCount.load(std::memory_order_acquire);
+  for (int id = 0; id < count; id++) {
+    Channel& channel = channels[id];
+    // channels with the same period are spread over different ticks, so the work per tick stays even
+    if ((tick + id) % channel.period != 0) continue;
+    std::size_t size = sizeof(lemlib::telemetry::ChannelSample) + channel.count * sizeof(float);
+    if (length + size > sizeof(payload)) {  // the record is full, send it and start another
+      lemlib::telemetry::send(lemlib::telemetry::RecordType::CHANNELS, payload, length);
+      length = 0;
+    }
+    float values[lemlib::telemetry::MAX_CHANNEL_VALUES] = {};
+    channel.getter(values);
+    lemlib::telemetry::ChannelSample header = {static_cast<std::uint8_t>(id), static_cast<std::uint8_t>(channel.count)};
+    std::memcpy(payload + length, &header, sizeof(header));
+    std::memcpy(payload + length + sizeof(header), values, channel.count * sizeof(float));
+    length += size;
+  }
+  if (length > 0) lemlib::telemetry::send(lemlib::telemetry::RecordType::CHANNELS, payload, length);
+}
+}  // namespace
+
+/**
+ * @brief Add a channel with several values
+ *
+ * @param name name of the channel. The string is copied
+ * @param rate how often the channel is sampled, in Hz
+ * @param count number of values in the channel, up to MAX_CHANNEL_VALUES
+ * @param getter function that writes the count values of the channel
+ * @return int id of the channel, -1 if there is no room for it
+ */
+int lemlib::telemetry::addChannel(const char* name, float rate, int count, std::function<void(float*)> getter) {
+  if (count < 1 || count > MAX_CHANNEL_VALUES || rate <= 0) return -1;
+  channelMutex.take();
+  int id = channelCount.load(std::memory_order_relaxed);
+  if (id < MAX_CHANNELS) {
+    Channel& channel = channels[id];
+    std::strncpy(channel.name, name, sizeof(channel.name) - 1);
+    channel.name[sizeof(channel.name) - 1] = '\0';
+    channel.period = std::fmax(1, std::round(CHANNEL_TICK_RATE / rate));
+    channel.count = count;
+    channel.getter = getter;
+    channelCount.store(id + 1, std::memory_order_release);
+  } else {
+    id = -1;
+  }
+  channelMutex.give();
+  return id;
+}
+
+/**
+ * @brief Add a channel with one value
+ *
+ * @param name name of the channel. The string is copied
+ * @param rate how often the channel is sampled, in Hz
+ * @param getter function that returns the value of the channel
+ * @return int id of the channel, -1 if there is no room for it
+ */
+int lemlib::telemetry::addChannel(const char* name, float rate, std::function<float()> getter) {
+  return addChannel(name, rate, 1, [getter](float* values) { values[0] = getter(); });
+}
+
+/**
+ * @brief Start the task that samples the channels
+ */
+void lemlib::telemetry::startChannels() {
+  if (started.exchange(true)) return;  // already started
+  pros::Task task(
+      [] {
+        std::uint32_t tick = 0;
+        std::uint32_t time = pros::millis();
+        while (true) {
+          if (tick % CHANNEL_TICK_RATE == 0) sendNames();
+          sample(tick);
+          tick++;
+          pros::Task::delay_until(&time, 1000 / CHANNEL_TICK_RATE);
+        }
+      },
+      TASK_PRIORITY_DEFAULT - 1, TASK_STACK_DEPTH_DEFAULT, "LemLib channels");
+}
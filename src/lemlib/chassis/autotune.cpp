@@ -0,0 +1,146 @@
+/**
+ * @file src/lemlib/chassis/autotune.cpp
+ * @author LemLib Team
+ * @brief Relay feedback PID autotuner
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// The robot is driven by a relay: full power towards its starting point, with a small hysteresis band. This makes
+// it oscillate around the starting point at its ultimate period, and the amplitude of the oscillation gives the
+// ultimate gain. From "Automatic tuning of simple regulators with specifications on phase and amplitude margins"
+// by Astrom and Hagglund
+
+#include <math.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/util.hpp"
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * @brief Tune the lateral or angular controller with relay feedback
+ *
+ * @param angular whether to tune the angular controller (true) or the lateral controller (false)
+ * @param relayPower the power of the relay
+ * @param cycles how many oscillations to measure
+ * @param filePath file to save the gains to, for loadGains(). No need to preface it with /usd/. Not saved if nullptr
+ * @return ChassisController_t the current settings of the controller, with the tuned kP and kD
+ */
+lemlib::ChassisController_t lemlib::Chassis::autotune(bool angular, float relayPower, int cycles,
+                                                      const char* filePath) {
+  ChassisController_t result = angular ? angularSettings : lateralSettings;
+  const float hysteresis = angular ? 1 : 0.25;  // keeps sensor noise from switching the relay, degrees or inches
+  const float maxDuration = 20000;
+  Pose start = getPose();
+  float relay = 1;
+  float max = 0, min = 0;
+  int lastSwitch = 0;
+  int measured = -1;  // the first oscillation is still settling into the limit cycle, so it is not measured
+  float totalAmplitude = 0, totalPeriod = 0;
+  int startTime = pros::millis();
+  std::uint8_t compState = pros::competition::get_status();
+
+  while (pros::competition::get_status() == compState && measured < cycles &&
+         pros::millis() - startTime < maxDuration) {
+    // position relative to the start, along the starting heading or around the starting heading
+    Pose pose = getPose();
+    float position;
+    if (angular) {
+      position = angleError(pose.theta, start.theta);
+    } else {
+      position = (pose.x - start.x) * std::sin(degToRad(start.theta)) +
+                 (pose.y - start.y) * std::cos(degToRad(start.theta));
+    }
+    if (position > max) max = position;
+    if (position < min) min = position;
+
+    // switch the relay once the robot has passed the start by more than the hysteresis
+    if (relay > 0 && position > hysteresis) {
+      relay = -1;
+      // a full oscillation ends every time the relay switches to reverse
+      int now = pros::millis();
+      if (lastSwitch != 0 && ++measured > 0) {
+        totalAmplitude += (max - min) / 2;
+        totalPeriod += (now - lastSwitch) / 1000.0;
+      }
+      lastSwitch = now;
+      max = position;
+      min = position;
+    } else if (relay < 0 && position < -hysteresis) {
+      relay = 1;
+    }
+
+    // move the drivetrain
+    float power = relay * relayPower;
+    drivetrain.leftMotors->move(power);
+    drivetrain.rightMotors->move(angular ? -power : power);
+    pros::delay(10);
+  }
+  drivetrain.leftMotors->move(0);
+  drivetrain.rightMotors->move(0);
+  if (measured < 1) {
+    printf("Autotune failed: the robot did not oscillate\n");
+    return result;
+  }
+
+  // ultimate gain and period, correcting the amplitude for the hysteresis
+  float amplitude = totalAmplitude / measured;
+  float period = totalPeriod / measured;
+  if (amplitude <= hysteresis) {
+    printf("Autotune failed: the oscillation is smaller than the hysteresis\n");
+    return result;
+  }
+  float ku = 4 * relayPower / (M_PI * std::sqrt(amplitude * amplitude - hysteresis * hysteresis));
+
+  // Ziegler-Nichols style rules for a PD controller. kD is per 10 ms update, like FAPID
+  struct {
+    const char* name;
+    float kP;
+    float derivativeTime;
+  } rules[] = {{"classic", 0.8f * ku, period / 8}, {"some overshoot", 0.33f * ku, period / 3},
+               {"no overshoot", 0.2f * ku, period / 3}};
+  printf("Autotune done: ku = %f, tu = %f s, amplitude = %f\n", ku, period, amplitude);
+  for (auto& rule : rules) {
+    printf("  %s: kP = %f, kD = %f\n", rule.name, rule.kP, rule.kP * rule.derivativeTime / 0.01);
+  }
+
+  // the robot should not overshoot between motions, so the no overshoot gains are used
+  result.kP = rules[2].kP;
+  result.kD = rules[2].kP * rules[2].derivativeTime / 0.01;
+  if (filePath != nullptr) {
+    std::ofstream file("/usd/" + std::string(filePath), std::ios::out);
+    if (file.is_open()) {
+      file << result.kP << " " << result.kD << std::endl;
+      printf("Autotune gains saved to /usd/%s\n", filePath);
+    } else {
+      printf("Autotune failed to save the gains to /usd/%s\n", filePath);
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Load gains saved by autotune into the lateral or angular controller
+ *
+ * @param angular whether to load the angular controller (true) or the lateral controller (false)
+ * @param filePath file the gains were saved to. No need to preface it with /usd/
+ * @return true the gains were loaded
+ * @return false the file could not be read, the gains are unchanged
+ */
+bool lemlib::Chassis::loadGains(bool angular, const char* filePath) {
+  std::ifstream file("/usd/" + std::string(filePath), std::ios::in);
+  float kP, kD;
+  if (!(file >> kP >> kD)) return false;
+  ChassisController_t& settings = angular ? angularSettings : lateralSettings;
+  settings.kP = kP;
+  settings.kD = kD;
+  return true;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file src/lemlib/chassis/boomerang.cpp
+ * @author LemLib Team
+ * @brief Boomerang move to pose implementation
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// The robot drives towards a carrot point placed behind the target, along the target heading.
+// The carrot slides towards the target as the robot gets closer, so the robot curves into the
+// target heading instead of turning once it has arrived
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/pid.hpp"
+#include "lemlib/util.hpp"
+#include "pros/misc.hpp"
+
+/**
+ * @brief Move the chassis to a pose, arriving at the target heading
+ *
+ * @param x x location
+ * @param y y location
+ * @param theta target heading in degrees, of the front of the robot even when driving backwards
+ * @param timeout longest time the robot can spend moving
+ * @param reversed whether the robot should drive backwards. false by default
+ * @param lead how far the carrot point is placed behind the target, as a ratio of the distance to the target
+ * @param maxSpeed the maximum speed the robot can move at
+ * @param log whether the chassis should log the moveToPose function. false by default
+ * @param async whether the function should return immediately and run the motion on the motion task
+ * @param minSpeed the minimum speed the robot drives at. If not 0, the motion is chained
+ * @param earlyExitRange how close to the target the chained motion exits, in inches
+ */
+void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, bool reversed, float lead, float maxSpeed,
+                                 bool log, bool async, float minSpeed, float earlyExitRange) {
+  // queue the motion on the motion task if it is asynchronous
+  if (async) {
+    queueMotion(
+        [=] { moveToPose(x, y, theta, timeout, reversed, lead, maxSpeed, log, false, minSpeed, earlyExitRange); });
+    return;
+  }
+  startMotion();
+  Pose target(x, y, degToRad(theta));
+  // the heading of the robot is flipped when driving backwards, so the target heading has to be flipped too
+  if (reversed) target.theta += M_PI;
+  Pose prevPose = getPose(true);
+  // seed the slew limiter with the output of the previous motion, if it was chained
+  float prevLateralPower = chainLateralPower;
+  float prevAngularPower = chainAngularPower;
+  bool close = false;
+  bool chained = false;
+  float velocity = 0;         // measured speed, in inches per second
+  float angularVelocity = 0;  // measured angular velocity, in degrees per second
+  int start = pros::millis();
+  std::uint8_t compState = pros::competition::get_status();
+
+  // create new PID controllers
+  FAPID lateralPID(0, 0, lateralSettings.kP, 0, lateralSettings.kD, "lateralPID");
+  FAPID angularPID(0, 0, angularSettings.kP, 0, angularSettings.kD, "angularPID");
+  lateralPID.setExit(lateralSettings.largeError, lateralSettings.smallError, lateralSettings.largeErrorTimeout,
+                     lateralSettings.smallErrorTimeout, timeout);
+  angularPID.setExit(angularSettings.largeError, angularSettings.smallError, angularSettings.largeErrorTimeout,
+                     angularSettings.smallErrorTimeout, timeout);
+  lateralPID.setSettle(lateralSettings.settleError, lateralSettings.settleVelocity, lateralSettings.settleTime);
+  angularPID.setSettle(angularSettings.settleError, angularSettings.settleVelocity, angularSettings.settleTime);
+
+  // main loop
+  while (pros::competition::get_status() == compState && !motionCanceled) {
+    // both controllers have to settle, and the robot has to be close to the target
+    bool lateralSettled = lateralPID.settled(velocity);
+    bool angularSettled = angularPID.settled(angularVelocity);
+    // a timeout ends the motion wherever the robot is, so a robot that is stuck can't stall the rest of the routine
+    if (lateralPID.getExit() == FAPID::Exit::TIMEOUT || angularPID.getExit() == FAPID::Exit::TIMEOUT) break;
+    if (close && lateralSettled && angularSettled) break;
+
+    // get the current position. The heading is flipped when driving backwards
+    Pose pose = getPose(true);
+    distTravelled = distTravelled + pose.distance(prevPose);
+    velocity = pose.distance(prevPose) / 0.01;
+    angularVelocity = radToDeg(pose.theta - prevPose.theta) / 0.01;
+    prevPose = pose;
+    if (reversed) pose.theta += M_PI;
+    float distTarget = pose.distance(target);
+
+    // exit a chained motion once the robot is close to the target
+    if (minSpeed != 0 && distTarget < earlyExitRange) {
+      chained = true;
+      break;
+    }
+
+    // once the robot is close, drive straight to the target and turn to the target heading
+    if (distTarget < 7.5) close = true;
+    Pose carrot = target;
+    if (!close) carrot = target - Pose(std::sin(target.theta), std::cos(target.theta)) * lead * distTarget;
+
+    // update error
+    float carrotAngle = std::atan2(carrot.x - pose.x, carrot.y - pose.y);
+    float carrotError = std::remainder(carrotAngle - pose.theta, 2 * M_PI);
+    float angularError = close ? std::remainder(target.theta - pose.theta, 2 * M_PI) : carrotError;
+    float lateralError = pose.distance(carrot) * std::cos(carrotError);
+
+    // calculate speed
+    scheduleGains(lateralPID, lateralSettings, lateralError);
+    scheduleGains(angularPID, angularSettings, radToDeg(angularError));
+    float lateralPower = lateralPID.update(lateralError, 0, log);
+    float angularPower = angularPID.update(radToDeg(angularError), 0, log);
+    if (std::fabs(lateralPower) < minSpeed) lateralPower = sgn(lateralPower) * minSpeed;
+
+    // limit acceleration
+    if (!close) lateralPower = lemlib::slew(lateralPower, prevLateralPower, lateralSettings.slew);
+    if (std::fabs(radToDeg(angularError)) > 25)
+      angularPower = lemlib::slew(angularPower, prevAngularPower, angularSettings.slew);
+
+    // cap the speed, turning takes priority over driving
+    angularPower = std::max(-maxSpeed, std::min(maxSpeed, angularPower));
+    float lateralLimit = maxSpeed - std::fabs(angularPower);
+    lateralPower = std::max(-lateralLimit, std::min(lateralLimit, lateralPower));
+
+    prevLateralPower = lateralPower;
+    prevAngularPower = angularPower;
+
+    // move the motors
+    if (reversed) lateralPower = -lateralPower;
+    output(DriveSide::LEFT, lateralPower + angularPower);
+    output(DriveSide::RIGHT, lateralPower - angularPower);
+
+    pros::delay(10);
+  }
+
+  // hand the speed to the next motion if the motion is chained, otherwise stop the drivetrain
+  if (chained) {
+    chainLateralPower = reversed ? -prevLateralPower : prevLateralPower;
+    chainAngularPower = prevAngularPower;
+  } else {
+    stop();
+  }
+  recordStats(start, lateralPID);
+  endMotion();
+}
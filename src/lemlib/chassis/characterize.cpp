@@ -0,0 +1,78 @@
+/**
+ * @file src/lemlib/chassis/characterize.cpp
+ * @author LemLib Team
+ * @brief Drivetrain feedforward characterization
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <math.h>
+
+#include <cstdio>
+
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/feedforwardFit.hpp"
+#include "lemlib/chassis/wheelController.hpp"
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * @brief Measure the feedforward constants of the drivetrain
+ *
+ * kS and kV are found with a least squares fit of power = kS + kV * velocity while the power slowly ramps up,
+ * so acceleration is negligible. kA is then fit to the power left over during a step in power, where
+ * the robot accelerates as hard as it can.
+ *
+ * @param maxDistance the furthest the robot can drive during each test, in inches
+ * @param rampRate how fast the power ramps up during the first test, in power per second
+ * @param stepPower the power used during the second test
+ * @return VelocityController_t the measured constants. kP is always 0
+ */
+lemlib::VelocityController_t lemlib::Chassis::characterize(float maxDistance, float rampRate, float stepPower) {
+  VelocityController_t result = {0, 0, 0, 0};
+  WheelController left(result, drivetrain.leftMotors, drivetrain.wheelDiameter, drivetrain.rpm);
+  WheelController right(result, drivetrain.rightMotors, drivetrain.wheelDiameter, drivetrain.rpm);
+  std::uint8_t compState = pros::competition::get_status();
+
+  FeedforwardFit fit;
+
+  // quasi-static test: ramp the power up slowly and fit power = kS + kV * velocity
+  Pose start = getPose();
+  for (int i = 0; pros::competition::get_status() == compState; i++) {
+    float power = rampRate * i * 0.01;
+    if (power > 127 || getPose().distance(start) > maxDistance) break;
+    drivetrain.leftMotors->move(power);
+    drivetrain.rightMotors->move(power);
+    pros::delay(10);
+    fit.addRampSample(power, (left.getVelocity() + right.getVelocity()) / 2);
+  }
+  drivetrain.leftMotors->move(0);
+  drivetrain.rightMotors->move(0);
+  if (!fit.fitRamp()) {
+    printf("Characterization failed: the robot did not move\n");
+    return result;
+  }
+  pros::delay(1000);  // let the robot come to a stop
+
+  // dynamic test: step the power in reverse and fit the leftover power to the acceleration
+  float prevVelocity = 0;
+  start = getPose();
+  while (pros::competition::get_status() == compState && getPose().distance(start) < maxDistance) {
+    drivetrain.leftMotors->move(-stepPower);
+    drivetrain.rightMotors->move(-stepPower);
+    pros::delay(10);
+    float velocity = -(left.getVelocity() + right.getVelocity()) / 2;
+    float acceleration = (velocity - prevVelocity) / 0.01;
+    prevVelocity = velocity;
+    fit.addStepSample(stepPower, velocity, acceleration);
+  }
+  drivetrain.leftMotors->move(0);
+  drivetrain.rightMotors->move(0);
+  result = fit.getConstants();
+
+  printf("Characterization done: kS = %f, kV = %f, kA = %f\n", result.kS, result.kV, result.kA);
+  return result;
+}
@@ -14,7 +14,11 @@
 
 #include "..\..\..\include\constants.hpp"
 #include "api.h"
+#include "lemlib/channels.hpp"
+#include "lemlib/chassis/motionControl.hpp"
 #include "lemlib/chassis/odom.hpp"
+#include "lemlib/chassis/pathProfile.hpp"
+#include "lemlib/chassis/wheelController.hpp"
 #include "lemlib/pid.hpp"
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
@@ -28,13 +32,18 @@
  * @param lateralSettings settings for the lateral controller
  * @param angularSetting settings for the angular controller
  * @param sensors sensors to be used for odometry
+ * @param followSettings settings for path following
+ * @param velocitySettings settings for the wheel velocity controllers
  */
 lemlib::Chassis::Chassis(Drivetrain_t drivetrain, ChassisController_t lateralSettings,
-                         ChassisController_t angularSettings, OdomSensors_t sensors) {
+                         ChassisController_t angularSettings, OdomSensors_t sensors, FollowSettings_t followSettings,
+                         VelocityController_t velocitySettings) {
   this->drivetrain = drivetrain;
   this->lateralSettings = lateralSettings;
   this->angularSettings = angularSettings;
   this->odomSensors = sensors;
+  this->followSettings = followSettings;
+  this->velocitySettings = velocitySettings;
 }
 
 /**
@@ -146,6 +155,32 @@ void lemlib::Chassis::setPose(Pose pose, bool radians) { lemlib::setPose(pose, r
  */
 lemlib::Pose lemlib::Chassis::getPose(bool radians) { return lemlib::getPose(radians); }
 
+/**
+ * @brief Get the motion profile moveTo uses to drive a distance
+ *
+ * @param distance the distance to drive in inches
+ * @param maxSpeed the maximum speed the robot can move at
+ * @return MotionProfile the profile
+ */
+lemlib::MotionProfile lemlib::Chassis::lateralProfile(float distance, float maxSpeed) {
+  return lemlib::lateralProfile(drivetrain, distance, maxSpeed);
+}
+
+/**
+ * @brief Get the motion profile turnTo uses to turn an angle
+ *
+ * The angular limits are the linear limits of the wheels, turning about the center of the robot,
+ * or about the locked side for a swing turn
+ *
+ * @param angle the angle to turn in degrees
+ * @param maxSpeed the maximum speed the robot can turn at
+ * @param swing whether the turn is a swing turn, pivoting around one side of the drivetrain
+ * @return MotionProfile the profile
+ */
+lemlib::MotionProfile lemlib::Chassis::angularProfile(float angle, float maxSpeed, bool swing) {
+  return lemlib::angularProfile(drivetrain, angle, maxSpeed, swing);
+}
+
 /**
  * @brief Turn the chassis so it is facing the target point
  *
@@ -157,50 +192,197 @@ lemlib::Pose lemlib::Chassis::getPose(bool radians) { return lemlib::getPose(rad
  * @param reversed whether the robot should turn in the opposite direction. false by default
  * @param maxSpeed the maximum speed the robot can turn at. Default is 200
  * @param log whether the chassis should log the turnTo function. false by default
+ * @param async whether the function should return immediately and run the motion on the motion task
+ * @param minSpeed the minimum speed the robot turns at. If not 0, the motion is chained: it exits once within
+ * earlyExitRange of the target without stopping, and hands its speed to the next motion
+ * @param earlyExitRange how close to the target heading the chained motion exits, in degrees
+ */
+void lemlib::Chassis::turnTo(float x, float y, int timeout, bool reversed, float maxSpeed, bool log, bool async,
+                             float minSpeed, float earlyExitRange) {
+  // queue the motion on the motion task if it is asynchronous
+  if (async) {
+    queueMotion([=] { turnTo(x, y, timeout, reversed, maxSpeed, log, false, minSpeed, earlyExitRange); });
+    return;
+  }
+  turn(x, y, 0, true, reversed, false, DriveSide::LEFT, timeout, maxSpeed, log, minSpeed, earlyExitRange);
+}
+
+/**
+ * @brief Turn the chassis to face a heading
+ *
+ * The PID logging id is "angularPID"
+ *
+ * @param heading the heading to face, in degrees
+ * @param timeout longest time the robot can spend moving
+ * @param maxSpeed the maximum speed the robot can turn at
+ * @param log whether the chassis should log the turnToHeading function. false by default
+ * @param async whether the function should return immediately and run the motion on the motion task
+ * @param minSpeed the minimum speed the robot turns at. If not 0, the motion is chained
+ * @param earlyExitRange how close to the target heading the chained motion exits, in degrees
  */
-void lemlib::Chassis::turnTo(float x, float y, int timeout, bool reversed, float maxSpeed, bool log) {
+void lemlib::Chassis::turnToHeading(float heading, int timeout, float maxSpeed, bool log, bool async, float minSpeed,
+                                    float earlyExitRange) {
+  // queue the motion on the motion task if it is asynchronous
+  if (async) {
+    queueMotion([=] { turnToHeading(heading, timeout, maxSpeed, log, false, minSpeed, earlyExitRange); });
+    return;
+  }
+  turn(0, 0, heading, false, false, false, DriveSide::LEFT, timeout, maxSpeed, log, minSpeed, earlyExitRange);
+}
+
+/**
+ * @brief Swing the chassis to face a heading, pivoting around one side of the drivetrain
+ *
+ * The PID logging id is "angularPID"
+ *
+ * @param heading the heading to face, in degrees
+ * @param lockedSide the side of the drivetrain that does not move
+ * @param timeout longest time the robot can spend moving
+ * @param maxSpeed the maximum speed the moving side can drive at
+ * @param log whether the chassis should log the swingToHeading function. false by default
+ * @param async whether the function should return immediately and run the motion on the motion task
+ * @param minSpeed the minimum speed the robot turns at. If not 0, the motion is chained
+ * @param earlyExitRange how close to the target heading the chained motion exits, in degrees
+ */
+void lemlib::Chassis::swingToHeading(float heading, DriveSide lockedSide, int timeout, float maxSpeed, bool log,
+                                     bool async, float minSpeed, float earlyExitRange) {
+  // queue the motion on the motion task if it is asynchronous
+  if (async) {
+    queueMotion([=] { swingToHeading(heading, lockedSide, timeout, maxSpeed, log, false, minSpeed, earlyExitRange); });
+    return;
+  }
+  turn(0, 0, heading, false, false, true, lockedSide, timeout, maxSpeed, log, minSpeed, earlyExitRange);
+}
+
+/**
+ * @brief Turn the chassis to face a point or a heading
+ *
+ * @param x x location of the point to face
+ * @param y y location of the point to face
+ * @param heading the heading to face, in degrees. Only used if facePoint is false
+ * @param facePoint whether to face the point (true) or the heading (false)
+ * @param reversed whether the back of the robot should face the point
+ * @param swing whether to swing around one side of the drivetrain instead of turning in place
+ * @param lockedSide the side of the drivetrain that does not move during a swing
+ * @param timeout longest time the robot can spend moving
+ * @param maxSpeed the maximum speed the robot can turn at
+ * @param log whether the chassis should log the turn
+ * @param minSpeed the minimum speed the robot turns at. If not 0, the motion is chained
+ * @param earlyExitRange how close to the target heading the chained motion exits, in degrees
+ */
+void lemlib::Chassis::turn(float x, float y, float heading, bool facePoint, bool reversed, bool swing,
+                           DriveSide lockedSide, int timeout, float maxSpeed, bool log, float minSpeed,
+                           float earlyExitRange) {
+  startMotion();
   Pose pose(0, 0);
-  float targetTheta;
+  float prevTheta = getPose().theta;
+  float targetTheta = heading;
   float deltaX, deltaY, deltaTheta;
-  float motorPower;
+  float motorPower = 0;
+  float startSign = 0;
+  bool chained = false;
+  // a profile starts from rest, so a turn that starts where a chained motion exited is not profiled
+  const bool profiled = motionProfiles && drivetrain.maxAcceleration != 0 && minSpeed == 0 && chainLateralPower == 0 &&
+                        chainAngularPower == 0;
+  // a swing pivots around the locked side, so the moving side is a full track width from the center of rotation
+  const float radius = swing ? drivetrain.trackWidth : drivetrain.trackWidth / 2;
+  MotionProfile profile(0, 0, 0);
+  float startTheta = 0;
+  float profileTime = 0;
+  bool profileDone = !profiled;
+  int start = pros::millis();
   std::uint8_t compState = pros::competition::get_status();
 
   // create a new PID controller
   FAPID pid = FAPID(0, 0, angularSettings.kP, 0, angularSettings.kD, "angularPID");
   pid.setExit(angularSettings.largeError, angularSettings.smallError, angularSettings.largeErrorTimeout,
               angularSettings.smallErrorTimeout, timeout);
+  pid.setSettle(angularSettings.settleError, angularSettings.settleVelocity, angularSettings.settleTime);
+  float velocity = 0;  // measured angular velocity, in degrees per second
 
   // main loop
-  while (pros::competition::get_status() == compState && !pid.settled()) {
+  while (pros::competition::get_status() == compState && !motionCanceled && int(pros::millis() - start) < timeout) {
+    // the error to the setpoint of a profile is small the whole way, so the controller is only checked once the
+    // profile is done, when the setpoint is the target
+    if (profileDone && pid.settled(velocity)) break;
+
     // update variables
     pose = getPose();
+    distTravelled = distTravelled + std::fabs(pose.theta - prevTheta);
+    velocity = (pose.theta - prevTheta) / 0.01;
+    prevTheta = pose.theta;
     pose.theta = (reversed) ? fmod(pose.theta - 180, 360) : fmod(pose.theta, 360);
-    deltaX = x - pose.x;
-    deltaY = y - pose.y;
-    targetTheta = fmod(radToDeg(M_PI_2 - atan2(deltaY, deltaX)), 360);
+    if (facePoint) {
+      deltaX = x - pose.x;
+      deltaY = y - pose.y;
+      targetTheta = fmod(radToDeg(M_PI_2 - atan2(deltaY, deltaX)), 360);
+    }
 
     // calculate deltaTheta
     deltaTheta = angleError(targetTheta, pose.theta);
 
-    // calculate the speed
-    motorPower = pid.update(0, deltaTheta, log);
+    // exit a chained motion once the robot is close to the target heading, or has turned past it
+    if (startSign == 0) {
+      startSign = sgn(deltaTheta);
+      startTheta = deltaTheta;
+      if (profiled) profile = angularProfile(deltaTheta, maxSpeed, swing);
+    }
+    if (minSpeed != 0 && (std::fabs(deltaTheta) < earlyExitRange || sgn(deltaTheta) != startSign)) {
+      chained = true;
+      break;
+    }
+
+    // calculate the speed. A profiled turn tracks the setpoint of the profile, with feedforward for the velocity and
+    // acceleration of the profile
+    float setpoint = 0;
+    if (profiled) {
+      profileTime = (pros::millis() - start) / 1000.0;
+      if (profileTime >= profile.getDuration()) profileDone = true;
+      setpoint = startTheta - profile.getPosition(profileTime);
+    }
+    // the gains are scheduled on the error the controller is fed, which is the error to the setpoint
+    scheduleGains(pid, angularSettings, deltaTheta - setpoint);
+    motorPower = pid.update(0, deltaTheta - setpoint, log);
+    if (profiled) {
+      motorPower -= feedforward(degToRad(profile.getVelocity(profileTime)) * radius,
+                                degToRad(profile.getAcceleration(profileTime)) * radius);
+    }
 
     // cap the speed
     if (motorPower > maxSpeed)
       motorPower = maxSpeed;
     else if (motorPower < -maxSpeed)
       motorPower = -maxSpeed;
-
-    // move the drivetrain
-    drivetrain.leftMotors->move(-motorPower);
-    drivetrain.rightMotors->move(motorPower);
+    if (std::fabs(motorPower) < minSpeed) motorPower = sgn(motorPower) * minSpeed;
+
+    // move the drivetrain. During a swing the locked side holds its position
+    if (swing && lockedSide == DriveSide::LEFT) {
+      drivetrain.leftMotors->move_velocity(0);
+      output(DriveSide::RIGHT, motorPower);
+    } else if (swing) {
+      output(DriveSide::LEFT, -motorPower);
+      drivetrain.rightMotors->move_velocity(0);
+    } else {
+      output(DriveSide::LEFT, -motorPower);
+      output(DriveSide::RIGHT, motorPower);
+    }
 
     pros::delay(10);
   }
 
-  // stop the drivetrain
-  drivetrain.leftMotors->move(0);
-  drivetrain.rightMotors->move(0);
+  // hand the speed to the next motion if the motion is chained, otherwise stop the drivetrain
+  if (chained && !swing) {
+    chainLateralPower = 0;
+    chainAngularPower = -motorPower;
+  } else if (chained) {
+    // only one side was moving, half of its power is lateral and half is angular
+    chainLateralPower = (lockedSide == DriveSide::LEFT) ? motorPower / 2 : -motorPower / 2;
+    chainAngularPower = -motorPower / 2;
+  } else {
+    stop();
+  }
+  recordStats(start, pid);
+  endMotion();
 }
 
 /**
@@ -212,84 +394,312 @@ void lemlib::Chassis::turnTo(float x, float y, int timeout, bool reversed, float
  * @param y y location
  * @param timeout longest time the robot can spend moving
  * @param maxSpeed the maximum speed the robot can move at
- * @param reversed whether the robot should turn in the opposite direction. false by default
  * @param log whether the chassis should log the moveTo function. false by default
+ * @param async whether the function should return immediately and run the motion on the motion task
+ * @param minSpeed the minimum speed the robot drives at. If not 0, the motion is chained: it exits once within
+ * earlyExitRange of the target without stopping, and hands its speed to the next motion
+ * @param earlyExitRange how close to the target the chained motion exits, in inches
  */
-void lemlib::Chassis::moveTo(float x, float y, int timeout, float maxSpeed, bool log) {
-  Pose pose(0, 0);
-  float prevLateralPower = 0;
-  float prevAngularPower = 0;
-  bool close = false;
+void lemlib::Chassis::moveTo(float x, float y, int timeout, float maxSpeed, bool log, bool async, float minSpeed,
+                             float earlyExitRange) {
+  // queue the motion on the motion task if it is asynchronous
+  if (async) {
+    queueMotion([=] { moveTo(x, y, timeout, maxSpeed, log, false, minSpeed, earlyExitRange); });
+    return;
+  }
+  startMotion();
+  MoveToController controller({drivetrain, lateralSettings, angularSettings, velocitySettings, outputMode}, x, y,
+                              timeout, maxSpeed, minSpeed, earlyExitRange,
+                              motionProfiles && drivetrain.maxAcceleration != 0, chainLateralPower, chainAngularPower);
+  Pose prevPose = getPose();
   int start = pros::millis();
   std::uint8_t compState = pros::competition::get_status();
 
-  // create a new PID controller
-  FAPID lateralPID(0, 0, lateralSettings.kP, 0, lateralSettings.kD, "lateralPID");
-  FAPID angularPID(0, 0, angularSettings.kP, 0, angularSettings.kD, "angularPID");
-  lateralPID.setExit(lateralSettings.largeError, lateralSettings.smallError, lateralSettings.largeErrorTimeout,
-                     lateralSettings.smallErrorTimeout, timeout);
-
   // main loop
-  while (pros::competition::get_status() == compState && (!lateralPID.settled() || pros::millis() - start < 300)) {
+  while (pros::competition::get_status() == compState && !motionCanceled && int(pros::millis() - start) < timeout) {
     // get the current position
     Pose pose = getPose();
-    pose.theta = std::fmod(pose.theta, 360);
-
-    // update error
-    float deltaX = x - pose.x;
-    float deltaY = y - pose.y;
-    float targetTheta = fmod(radToDeg(M_PI_2 - atan2(deltaY, deltaX)), 360);
-    float hypot = std::hypot(deltaX, deltaY);
-    float diffTheta1 = angleError(pose.theta, targetTheta);
-    float diffTheta2 = angleError(pose.theta, targetTheta + 180);
-    float angularError = (std::fabs(diffTheta1) < std::fabs(diffTheta2)) ? diffTheta1 : diffTheta2;
-    float lateralError = hypot * cos(degToRad(std::fabs(diffTheta1)));
-
-    // calculate speed
-    float lateralPower = lateralPID.update(lateralError, 0, log);
-    float angularPower = -angularPID.update(angularError, 0, log);
-
-    // if the robot is close to the target
-    if (pose.distance(lemlib::Pose(x, y)) < 7.5) {
-      close = true;
-      maxSpeed = (std::fabs(prevLateralPower) < 30) ? 30 : std::fabs(prevLateralPower);
-    }
+    distTravelled = distTravelled + pose.distance(prevPose);
+    prevPose = pose;
 
-    // limit acceleration
-    if (!close) lateralPower = lemlib::slew(lateralPower, prevLateralPower, lateralSettings.slew);
-    if (std::fabs(angularError) > 25)
-      angularPower = lemlib::slew(angularPower, prevAngularPower, angularSettings.slew);
-
-    // cap the speed
-    if (lateralPower > maxSpeed)
-      lateralPower = maxSpeed;
-    else if (lateralPower < -maxSpeed)
-      lateralPower = -maxSpeed;
-    if (close) angularPower = 0;
-
-    prevLateralPower = lateralPower;
-    prevAngularPower = angularPower;
-
-    float leftPower = lateralPower + angularPower;
-    float rightPower = lateralPower - angularPower;
-
-    // ratio the speeds to respect the max speed
-    float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / maxSpeed;
-    if (ratio > 1) {
-      leftPower /= ratio;
-      rightPower /= ratio;
-    }
+    // calculate the speed, until the motion settles or a chained motion reaches the target
+    float time = (pros::millis() - start) / 1000.0;
+    if (!controller.update(pose, time, pros::battery::get_voltage() / 1000.0, log)) break;
 
     // move the motors
-    drivetrain.leftMotors->move(leftPower);
-    drivetrain.rightMotors->move(rightPower);
+    output(DriveSide::LEFT, controller.getLeftPower());
+    output(DriveSide::RIGHT, controller.getRightPower());
 
     pros::delay(10);
   }
 
-  // stop the drivetrain
+  // hand the speed to the next motion if the motion is chained, otherwise stop the drivetrain
+  if (controller.isChained()) {
+    chainLateralPower = controller.getLateralPower();
+    chainAngularPower = controller.getAngularPower();
+  } else {
+    stop();
+  }
+  recordStats(start, controller.getLateralPID());
+  endMotion();
+}
+
+/**
+ * @brief Calculate the motor power needed to drive the wheels at a velocity
+ *
+ * @param velocity wheel velocity in inches per second
+ * @param acceleration wheel acceleration in inches per second squared
+ * @return float motor power, out of 127
+ */
+float lemlib::Chassis::feedforward(float velocity, float acceleration) {
+  return lemlib::feedforward({drivetrain, lateralSettings, angularSettings, velocitySettings, outputMode}, velocity,
+                             acceleration);
+}
+
+/**
+ * @brief Stop the drivetrain at the end of a motion
+ *
+ * The next motion starts from rest
+ */
+void lemlib::Chassis::stop() {
   drivetrain.leftMotors->move(0);
   drivetrain.rightMotors->move(0);
+  chainLateralPower = 0;
+  chainAngularPower = 0;
+}
+
+/**
+ * @brief Wait until the current motion and all queued motions are done
+ *
+ */
+void lemlib::Chassis::waitUntilDone() {
+  while (isInMotion()) pros::delay(10);
+}
+
+/**
+ * @brief Wait until the current motion has travelled a distance, or has ended
+ *
+ * @param dist the distance to wait for, in inches (or degrees for turns)
+ */
+void lemlib::Chassis::waitUntilDistance(float dist) {
+  // wait for a queued motion to start
+  while (!motionRunning && isInMotion()) pros::delay(10);
+  while (isInMotion() && motionRunning && distTravelled < dist) pros::delay(10);
+}
+
+/**
+ * @brief Whether the chassis is running a motion, or has motions queued
+ *
+ * @return true - a motion is running or queued
+ * @return false - the chassis is idle
+ */
+bool lemlib::Chassis::isInMotion() {
+  // a motion run on the autonomous or opcontrol task is deleted with it when the competition state changes, before
+  // it can end itself. Motions on the motion task exit on their own when the state changes
+  if (motionRunning && motionState != pros::competition::get_status()) {
+    motionMutex.take();
+    if (motionRunning && motionState != pros::competition::get_status()) {
+      endMotion();
+      chainLateralPower = 0;
+      chainAngularPower = 0;
+    }
+    motionMutex.give();
+  }
+  return motionRunning || motionsQueued > 0;
+}
+
+/**
+ * @brief Cancel the current motion and all queued motions
+ *
+ */
+void lemlib::Chassis::cancel() {
+  motionMutex.take();
+  motionsQueued -= motionQueue.size();
+  motionQueue.clear();
+  // checked while the queue is locked, so a motion the motion task has just taken off the queue is canceled too
+  if (motionRunning) motionCanceled = true;
+  motionMutex.give();
+}
+
+/**
+ * @brief Queue a motion to run on the motion task
+ *
+ * Motions run one at a time, in the order they were queued
+ *
+ * @param motion the motion to run
+ */
+void lemlib::Chassis::queueMotion(std::function<void()> motion) {
+  motionMutex.take();
+  motionQueue.push_back({pros::competition::get_status(), motion});
+  motionsQueued++;
+
+  // start the motion task if it is not running yet. This is done with the queue locked, so two tasks queueing
+  // motions at the same time can't both start one
+  if (motionTask == nullptr) {
+    motionTask = new pros::Task {[=] {
+      while (true) {
+        // get the next motion
+        std::function<void()> next = nullptr;
+        motionMutex.take();
+        // drop motions queued in another competition state, so motions left over from autonomous don't drive the
+        // robot in driver control
+        while (!motionQueue.empty() && motionQueue.front().first != pros::competition::get_status()) {
+          motionQueue.pop_front();
+          motionsQueued--;
+        }
+        if (!motionQueue.empty()) {
+          next = motionQueue.front().second;
+          motionQueue.pop_front();
+          // mark the motion as running before the queue is unlocked, so cancel() can't miss it
+          motionCanceled = false;
+          motionState = pros::competition::get_status();
+          motionRunning = true;
+        }
+        motionMutex.give();
+
+        // run it
+        if (next != nullptr) {
+          next();
+          motionsQueued--;
+        }
+        pros::delay(10);
+      }
+    }};
+  }
+  motionMutex.give();
+}
+
+/**
+ * @brief Mark the start of a motion. Waits for queued motions first, unless called from the motion task
+ *
+ */
+void lemlib::Chassis::startMotion() {
+  // motions from the motion task were marked as running when they were taken off the queue
+  if (motionTask == nullptr || pros::c::task_get_current() != static_cast<pros::task_t>(*motionTask)) {
+    waitUntilDone();
+    motionMutex.take();
+    motionCanceled = false;
+    motionState = pros::competition::get_status();
+    motionRunning = true;
+    motionMutex.give();
+  }
+  distTravelled = 0;
+  // a chained motion continues at the velocity of the previous motion
+  prevLeftVelocity = (chainLateralPower + chainAngularPower) * lemlib::maxVelocity(drivetrain) / 127;
+  prevRightVelocity = (chainLateralPower - chainAngularPower) * lemlib::maxVelocity(drivetrain) / 127;
+}
+
+/**
+ * @brief Mark the end of a motion
+ *
+ */
+void lemlib::Chassis::endMotion() {
+  motionRunning = false;
+  distTravelled = -1;
+}
+
+/**
+ * @brief Drive one side of the drivetrain with the output of a controller, using the output mode
+ *
+ * @param side the side of the drivetrain
+ * @param power the output of the controller, out of 127
+ */
+void lemlib::Chassis::output(DriveSide side, float power) {
+  pros::Motor_Group* motors = (side == DriveSide::LEFT) ? drivetrain.leftMotors : drivetrain.rightMotors;
+  float& prevVelocity = (side == DriveSide::LEFT) ? prevLeftVelocity : prevRightVelocity;
+  WheelController controller(velocitySettings, motors, drivetrain.wheelDiameter, drivetrain.rpm);
+  // the motors are only read for the feedback of the wheel velocity controller
+  bool feedback = outputMode == OutputMode::WHEEL_VELOCITY && velocitySettings.kP != 0;
+  SideOutput_t command = sideOutput({drivetrain, lateralSettings, angularSettings, velocitySettings, outputMode}, power,
+                                    prevVelocity, feedback ? controller.getVelocity() : 0);
+  if (command.velocity) {
+    controller.moveVelocity(command.value);
+  } else {
+    motors->move(command.value);
+  }
+}
+
+/**
+ * @brief Set how turnTo, turnToHeading, swingToHeading, moveTo and moveToPose drive the motors
+ *
+ * @param mode the output mode
+ */
+void lemlib::Chassis::setOutputMode(OutputMode mode) { outputMode = mode; }
+
+/**
+ * @brief Set whether turnTo, turnToHeading, swingToHeading and moveTo follow motion profiles
+ *
+ * @param enabled whether the motions follow motion profiles
+ */
+void lemlib::Chassis::setMotionProfiles(bool enabled) { motionProfiles = enabled; }
+
+/**
+ * @brief Update the gains of a controller from its gain schedule, if it has one
+ *
+ * Gains posted from the terminal replace the schedule, so they are not overwritten while they are being tuned
+ *
+ * @param pid the controller
+ * @param settings the settings of the controller
+ * @param error the error the controller is fed
+ */
+void lemlib::Chassis::scheduleGains(FAPID& pid, const ChassisController_t& settings, float error) {
+  lemlib::scheduleGains(pid, settings, error, pros::battery::get_voltage() / 1000.0);
+}
+
+/**
+ * @brief Record the statistics of a motion
+ *
+ * @param start the time the motion started, in milliseconds
+ * @param pid the controller that decides when the motion exits
+ */
+void lemlib::Chassis::recordStats(int start, FAPID& pid) {
+  motionMutex.take();
+  motionStats = {int(pros::millis() - start), pid.getSettleTime(), pid.getExit()};
+  motionMutex.give();
+}
+
+/**
+ * @brief Get the statistics of the last motion that finished
+ *
+ * @return MotionStats_t the statistics
+ */
+lemlib::MotionStats_t lemlib::Chassis::getMotionStats() {
+  motionMutex.take();
+  MotionStats_t stats = motionStats;
+  motionMutex.give();
+  return stats;
+}
+
+/**
+ * @brief Add telemetry channels for the chassis
+ *
+ * @param poseRate how often the pose is sampled, in Hz
+ * @param velocityRate how often the wheel velocities are sampled, in Hz
+ * @param temperatureRate how often the motor temperatures are sampled, in Hz
+ */
+void lemlib::Chassis::addTelemetry(float poseRate, float velocityRate, float temperatureRate) {
+  telemetry::addChannel("odom.pose", poseRate, 3, [](float* values) {
+    Pose pose = lemlib::getPose();
+    values[0] = pose.x;
+    values[1] = pose.y;
+    values[2] = pose.theta;
+  });
+  telemetry::addChannel("chassis.velocity", velocityRate, 2, [this](float* values) {
+    values[0] = WheelController(velocitySettings, drivetrain.leftMotors, drivetrain.wheelDiameter, drivetrain.rpm)
+                    .getVelocity();
+    values[1] = WheelController(velocitySettings, drivetrain.rightMotors, drivetrain.wheelDiameter, drivetrain.rpm)
+                    .getVelocity();
+  });
+  telemetry::addChannel("chassis.temperature", temperatureRate, 2, [this](float* values) {
+    pros::Motor_Group* groups[2] = {drivetrain.leftMotors, drivetrain.rightMotors};
+    for (int side = 0; side < 2; side++) {
+      // index the motors directly so no vectors are allocated
+      float hottest = 0;
+      int count = groups[side]->size();
+      for (int i = 0; i < count; i++) hottest = std::fmax(hottest, (*groups[side])[i].get_temperature());
+      values[side] = hottest;
+    }
+  });
 }
 
 void lemlib::Chassis::set_drive_brake(pros::motor_brake_mode_e_t brake_type) {
@@ -304,17 +714,50 @@ void lemlib::Chassis::set_tank(int left, int right) {
   drivetrain.rightMotors->move(right);
 }
 
+/**
+ * @brief Drive with tank controls, holding the robot in place when the sticks are released
+ *
+ * @param l_stick power of the left side
+ * @param r_stick power of the right side
+ * @param active_brake_kp gain of the active brake, in power per degree of the motors
+ */
 void lemlib::Chassis::drive(int l_stick, int r_stick, double active_brake_kp) {
   if (abs(l_stick) > JOYSTICK_THRESHOLD || abs(r_stick) > JOYSTICK_THRESHOLD) {
     set_tank(l_stick, r_stick);
-    if (active_brake_kp != 0) reset_drive_sensor();
+    brakeLatched = false;  // latch new hold positions the next time the sticks are released
   }
   // When joys are released, run active brake (P) on drive
-  else {
-    set_tank((-drivetrain.leftMotors->get_positions()[0]) * active_brake_kp, (-drivetrain.rightMotors->get_positions()[0]) * active_brake_kp);
+  else if (active_brake_kp == 0) {
+    set_tank(0, 0);
+  } else {
+    // hold the positions the sides were at when the sticks were released, instead of taring the motors (which
+    // would also need the IMU zeroed, and breaks odometry)
+    float left = drivePosition(DriveSide::LEFT);
+    float right = drivePosition(DriveSide::RIGHT);
+    if (!brakeLatched) {
+      leftHold = left;
+      rightHold = right;
+      brakeLatched = true;
+    }
+    set_tank((leftHold - left) * active_brake_kp, (rightHold - right) * active_brake_kp);
   }
 }
 
+/**
+ * @brief Get the position of one side of the drivetrain
+ *
+ * @param side the side
+ * @return float mean position of the motors of the side, in the units of their encoders
+ */
+float lemlib::Chassis::drivePosition(DriveSide side) {
+  pros::Motor_Group* motors = (side == DriveSide::LEFT) ? drivetrain.leftMotors : drivetrain.rightMotors;
+  // index the motors directly so no vectors are allocated
+  float total = 0;
+  int count = motors->size();
+  for (int i = 0; i < count; i++) total += (*motors)[i].get_position();
+  return (count > 0) ? total / count : 0;
+}
+
 void lemlib::Chassis::reset_drive_sensor() {
   drivetrain.leftMotors->tare_position();
   drivetrain.rightMotors->tare_position();
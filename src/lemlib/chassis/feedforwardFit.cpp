@@ -0,0 +1,63 @@
+/**
+ * @file src/lemlib/chassis/feedforwardFit.cpp
+ * @author LemLib Team
+ * @brief Least squares fit of the drivetrain feedforward constants
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/chassis/feedforwardFit.hpp"
+
+/**
+ * @brief Add a sample of the quasi-static test, where the power ramps up slowly
+ *
+ * @param power the power of the drivetrain, out of 127
+ * @param velocity the wheel velocity, in inches per second
+ */
+void lemlib::FeedforwardFit::addRampSample(float power, float velocity) {
+  if (velocity < 1) return;  // the robot has not started moving yet
+  n++;
+  sumV += velocity;
+  sumP += power;
+  sumVV += velocity * velocity;
+  sumVP += velocity * power;
+}
+
+/**
+ * @brief Fit kS and kV to the samples of the quasi-static test, with power = kS + kV * velocity
+ *
+ * @return true - the fit succeeded
+ * @return false - the robot did not move
+ */
+bool lemlib::FeedforwardFit::fitRamp() {
+  if (n < 2 || n * sumVV - sumV * sumV == 0) return false;
+  kV = (n * sumVP - sumV * sumP) / (n * sumVV - sumV * sumV);
+  kS = (sumP - kV * sumV) / n;
+  return true;
+}
+
+/**
+ * @brief Add a sample of the dynamic test, where the power steps up and the robot accelerates
+ *
+ * @param power the power of the drivetrain, out of 127
+ * @param velocity the wheel velocity, in inches per second
+ * @param acceleration the wheel acceleration, in inches per second squared
+ */
+void lemlib::FeedforwardFit::addStepSample(float power, float velocity, float acceleration) {
+  if (velocity < 1 || acceleration < 5) return;  // only use samples where the robot is accelerating
+  float residual = power - kS - kV * velocity;
+  sumAA += acceleration * acceleration;
+  sumAR += acceleration * residual;
+}
+
+/**
+ * @brief Get the fitted constants
+ *
+ * @return VelocityController_t the constants. kP is always 0
+ */
+lemlib::VelocityController_t lemlib::FeedforwardFit::getConstants() {
+  return {kS, kV, (sumAA != 0) ? sumAR / sumAA : 0, 0};
+}
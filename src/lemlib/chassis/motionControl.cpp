@@ -0,0 +1,299 @@
+/**
+ * @file src/lemlib/chassis/motionControl.cpp
+ * @author LemLib Team
+ * @brief Control laws of the chassis motions
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/chassis/motionControl.hpp"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "lemlib/chassis/pathProfile.hpp"
+#include "lemlib/util.hpp"
+
+/**
+ * @brief Get the power for one side of the drivetrain from the wheel velocity controller
+ *
+ * @param constants the velocity controller constants
+ * @param targetVelocity the target wheel velocity in inches per second
+ * @param targetAcceleration the target wheel acceleration in inches per second squared
+ * @param velocity the measured wheel velocity in inches per second. Only used if kP is not 0
+ * @return float power out of 127
+ */
+float lemlib::wheelPower(VelocityController_t constants, float targetVelocity, float targetAcceleration,
+                         float velocity) {
+  float output = constants.kV * targetVelocity + constants.kA * targetAcceleration;
+  if (targetVelocity != 0) output += constants.kS * lemlib::sgn(targetVelocity);
+  if (constants.kP != 0) output += constants.kP * (targetVelocity - velocity);
+  if (output > 127) output = 127;
+  else if (output < -127) output = -127;
+  return output;
+}
+
+/**
+ * @brief Get the command for one side of the drivetrain from the output of a controller, using the output mode
+ *
+ * @param constants the constants of the chassis
+ * @param power the output of the controller, out of 127
+ * @param prevVelocity the velocity of the last output of this side, in inches per second. Updated
+ * @param velocity the measured wheel velocity in inches per second. Only used by the wheel velocity controller
+ * @return SideOutput_t the command
+ */
+lemlib::SideOutput_t lemlib::sideOutput(const ChassisConstants_t& constants, float power, float& prevVelocity,
+                                        float velocity) {
+  float targetVelocity = power * lemlib::maxVelocity(constants.drivetrain) / 127;
+  SideOutput_t output;
+  if (constants.outputMode == OutputMode::VOLTAGE) {
+    output = {false, power};
+  } else if (constants.outputMode == OutputMode::WHEEL_VELOCITY && constants.velocitySettings.kV != 0) {
+    float targetAcceleration = (targetVelocity - prevVelocity) / 0.01;
+    output = {false, wheelPower(constants.velocitySettings, targetVelocity, targetAcceleration, velocity)};
+  } else {
+    output = {true, targetVelocity};
+  }
+  prevVelocity = targetVelocity;
+  return output;
+}
+
+/**
+ * @brief Calculate the motor power needed to drive the wheels at a velocity
+ *
+ * @param constants the constants of the chassis
+ * @param velocity wheel velocity in inches per second
+ * @param acceleration wheel acceleration in inches per second squared
+ * @return float motor power, out of 127
+ */
+float lemlib::feedforward(const ChassisConstants_t& constants, float velocity, float acceleration) {
+  const VelocityController_t& settings = constants.velocitySettings;
+  // in the velocity output modes the output is already a velocity, the inner velocity loop does the feedforward
+  if (settings.kV == 0 || constants.outputMode != OutputMode::VOLTAGE) {
+    return velocity * 127 / lemlib::maxVelocity(constants.drivetrain);
+  }
+  float power = settings.kV * velocity + settings.kA * acceleration;
+  if (velocity != 0) power += settings.kS * lemlib::sgn(velocity);
+  return power;
+}
+
+/**
+ * @brief Update the gains of a controller from its gain schedule, if it has one
+ *
+ * @param pid the controller
+ * @param settings the settings of the controller
+ * @param error the error the controller is fed
+ * @param batteryVoltage the battery voltage, in volts
+ */
+void lemlib::scheduleGains(FAPID& pid, const ChassisController_t& settings, float error, float batteryVoltage) {
+  if (settings.schedule == nullptr || pid.hasPostedGains()) return;
+  Gains_t gains = settings.schedule->get(error, batteryVoltage);
+  pid.setGains(0, 0, gains.kP, 0, gains.kD);
+}
+
+/**
+ * @brief Get the motion profile moveTo uses to drive a distance
+ *
+ * @param drivetrain the drivetrain
+ * @param distance the distance to drive in inches
+ * @param maxSpeed the maximum speed the robot can move at
+ * @return MotionProfile the profile
+ */
+lemlib::MotionProfile lemlib::lateralProfile(const Drivetrain_t& drivetrain, float distance, float maxSpeed) {
+  float maxVel = std::min(lemlib::maxVelocity(drivetrain), maxSpeed * lemlib::maxVelocity(drivetrain) / 127);
+  return MotionProfile(distance, maxVel, drivetrain.maxAcceleration, drivetrain.maxJerk);
+}
+
+/**
+ * @brief Get the motion profile turnTo uses to turn an angle
+ *
+ * @param drivetrain the drivetrain
+ * @param angle the angle to turn in degrees
+ * @param maxSpeed the maximum speed the robot can turn at
+ * @param swing whether the turn is a swing turn, pivoting around one side of the drivetrain
+ * @return MotionProfile the profile
+ */
+lemlib::MotionProfile lemlib::angularProfile(const Drivetrain_t& drivetrain, float angle, float maxSpeed,
+                                             bool swing) {
+  float radius = swing ? drivetrain.trackWidth : drivetrain.trackWidth / 2;
+  float maxVel = std::min(lemlib::maxVelocity(drivetrain), maxSpeed * lemlib::maxVelocity(drivetrain) / 127);
+  return MotionProfile(angle, radToDeg(maxVel / radius), radToDeg(drivetrain.maxAcceleration / radius),
+                       radToDeg(drivetrain.maxJerk / radius));
+}
+
+/**
+ * @brief Construct a new Move To Controller
+ *
+ * @param constants the constants of the chassis
+ * @param x x location of the target
+ * @param y y location of the target
+ * @param timeout longest time the robot can spend moving, in milliseconds
+ * @param maxSpeed the maximum speed the robot can move at
+ * @param minSpeed the minimum speed the robot drives at. If not 0, the motion is chained
+ * @param earlyExitRange how close to the target the chained motion exits, in inches
+ * @param profile whether the motion follows a motion profile. Profiles start from rest, so chained motions
+ * and motions that start where a chained motion exited never do
+ * @param chainLateralPower lateral power handed over by the previous motion. 0 if it stopped
+ * @param chainAngularPower angular power handed over by the previous motion. 0 if it stopped
+ */
+lemlib::MoveToController::MoveToController(const ChassisConstants_t& constants, float x, float y, int timeout,
+                                           float maxSpeed, float minSpeed, float earlyExitRange, bool profile,
+                                           float chainLateralPower, float chainAngularPower)
+    : constants(constants),
+      x(x),
+      y(y),
+      maxSpeed(maxSpeed),
+      minSpeed(minSpeed),
+      earlyExitRange(earlyExitRange),
+      profiled(profile && minSpeed == 0 && chainLateralPower == 0 && chainAngularPower == 0),
+      lateralPID(0, 0, constants.lateralSettings.kP, 0, constants.lateralSettings.kD, "lateralPID"),
+      angularPID(0, 0, constants.angularSettings.kP, 0, constants.angularSettings.kD, "angularPID"),
+      profileDone(!this->profiled),
+      // seed the slew limiter with the output of the previous motion, if it was chained
+      prevLateralPower(chainLateralPower),
+      prevAngularPower(chainAngularPower) {
+  const ChassisController_t& lateral = constants.lateralSettings;
+  lateralPID.setExit(lateral.largeError, lateral.smallError, lateral.largeErrorTimeout, lateral.smallErrorTimeout,
+                     timeout);
+  lateralPID.setSettle(lateral.settleError, lateral.settleVelocity, lateral.settleTime);
+}
+
+/**
+ * @brief Update the controller. Must be called every 10 ms
+ *
+ * @param pose the pose of the robot, with theta in degrees
+ * @param time time since the start of the motion, in seconds
+ * @param batteryVoltage the battery voltage, in volts. Used by the gain schedules
+ * @param log whether the controllers check for gains posted from the terminal
+ * @return true - the motion is running, drive the motors with getLeftPower() and getRightPower()
+ * @return false - the motion has exited
+ */
+bool lemlib::MoveToController::update(Pose pose, float time, float batteryVoltage, bool log) {
+  // the error to the setpoint of a profile is small the whole way, so the controller is only checked once the
+  // profile is done, when the setpoint is the target
+  if (profileDone && lateralPID.settled(velocity)) return false;
+
+  // get the current position
+  if (!started) prevPose = pose;
+  velocity = pose.distance(prevPose) / 0.01;
+  prevPose = pose;
+  pose.theta = std::fmod(pose.theta, 360);
+
+  // update error
+  float deltaX = x - pose.x;
+  float deltaY = y - pose.y;
+  float targetTheta = fmod(radToDeg(M_PI_2 - atan2(deltaY, deltaX)), 360);
+  float hypot = std::hypot(deltaX, deltaY);
+  float diffTheta1 = angleError(pose.theta, targetTheta);
+  float diffTheta2 = angleError(pose.theta, targetTheta + 180);
+  float angularError = (std::fabs(diffTheta1) < std::fabs(diffTheta2)) ? diffTheta1 : diffTheta2;
+  float lateralError = hypot * cos(degToRad(std::fabs(diffTheta1)));
+
+  // exit a chained motion once the robot is close to the target, or has driven past it
+  if (!started) {
+    started = true;
+    startSign = sgn(lateralError);
+    startDistance = hypot;
+    if (profiled) profile = lateralProfile(constants.drivetrain, hypot, maxSpeed);
+  }
+  if (minSpeed != 0 && (hypot < earlyExitRange || sgn(lateralError) != startSign)) {
+    chained = true;
+    return false;
+  }
+
+  // calculate speed. A profiled motion tracks the setpoint of the profile, with feedforward for the velocity and
+  // acceleration of the profile
+  float setpoint = 0;
+  if (profiled) {
+    if (time >= profile.getDuration()) profileDone = true;
+    setpoint = startSign * (startDistance - profile.getPosition(time));
+  }
+  // the gains are scheduled on the error the controllers are fed, which is the error to the setpoint
+  scheduleGains(lateralPID, constants.lateralSettings, lateralError - setpoint, batteryVoltage);
+  scheduleGains(angularPID, constants.angularSettings, angularError, batteryVoltage);
+  float lateralPower = lateralPID.update(lateralError - setpoint, 0, log);
+  if (profiled) {
+    lateralPower += startSign * feedforward(constants, profile.getVelocity(time), profile.getAcceleration(time));
+  }
+  float angularPower = -angularPID.update(angularError, 0, log);
+
+  // if the robot is close to the target
+  // a profiled motion already slows down on its own
+  if (!profiled && pose.distance(lemlib::Pose(x, y)) < 7.5) {
+    close = true;
+    maxSpeed = (std::fabs(prevLateralPower) < 30) ? 30 : std::fabs(prevLateralPower);
+  }
+
+  // limit acceleration
+  if (!close && !profiled) lateralPower = slew(lateralPower, prevLateralPower, constants.lateralSettings.slew);
+  if (std::fabs(angularError) > 25) angularPower = slew(angularPower, prevAngularPower, constants.angularSettings.slew);
+
+  // cap the speed
+  if (lateralPower > maxSpeed)
+    lateralPower = maxSpeed;
+  else if (lateralPower < -maxSpeed)
+    lateralPower = -maxSpeed;
+  if (close) angularPower = 0;
+  if (std::fabs(lateralPower) < minSpeed) lateralPower = sgn(lateralPower) * minSpeed;
+
+  prevLateralPower = lateralPower;
+  prevAngularPower = angularPower;
+
+  leftPower = lateralPower + angularPower;
+  rightPower = lateralPower - angularPower;
+
+  // ratio the speeds to respect the max speed
+  float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / maxSpeed;
+  if (ratio > 1) {
+    leftPower /= ratio;
+    rightPower /= ratio;
+  }
+  return true;
+}
+
+/**
+ * @brief Get the output for the left side of the drivetrain
+ *
+ * @return float power out of 127
+ */
+float lemlib::MoveToController::getLeftPower() { return leftPower; }
+
+/**
+ * @brief Get the output for the right side of the drivetrain
+ *
+ * @return float power out of 127
+ */
+float lemlib::MoveToController::getRightPower() { return rightPower; }
+
+/**
+ * @brief Whether the motion exited as a chained motion, and hands its speed to the next motion
+ *
+ * @return true - the motion is chained and has exited
+ * @return false - the motion is running, or has settled
+ */
+bool lemlib::MoveToController::isChained() { return chained; }
+
+/**
+ * @brief Get the last lateral output, which a chained motion hands to the next motion
+ *
+ * @return float power out of 127
+ */
+float lemlib::MoveToController::getLateralPower() { return prevLateralPower; }
+
+/**
+ * @brief Get the last angular output, which a chained motion hands to the next motion
+ *
+ * @return float power out of 127
+ */
+float lemlib::MoveToController::getAngularPower() { return prevAngularPower; }
+
+/**
+ * @brief Get the lateral controller, which decides when the motion exits
+ *
+ * @return FAPID& the controller
+ */
+lemlib::FAPID& lemlib::MoveToController::getLateralPID() { return lateralPID; }
@@ -17,6 +17,8 @@
 #include <math.h>
 #include "pros/rtos.hpp"
 #include "lemlib/util.hpp"
+#include "lemlib/monitor.hpp"
+#include "lemlib/profiler.hpp"
 #include "lemlib/chassis/odom.hpp"
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/chassis/trackingWheel.hpp"
@@ -75,6 +77,7 @@ void lemlib::setPose(lemlib::Pose pose, bool radians) {
  *
  */
 void lemlib::update() {
+    lemlib::profiler::Scope scope("odom update");
     // TODO: add particle filter
     // get the current sensor values
     float vertical1Raw = 0;
@@ -178,8 +181,11 @@ void lemlib::update() {
 void lemlib::init() {
     if (trackingTask == nullptr) {
         trackingTask = new pros::Task {[=] {
+            int loop = lemlib::monitor::addLoop("odom", 10);
             while (true) {
+                lemlib::monitor::beginLoop(loop);
                 update();
+                lemlib::monitor::endLoop(loop);
                 pros::delay(10);
             }
         }};
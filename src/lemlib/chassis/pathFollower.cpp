@@ -0,0 +1,418 @@
+/**
+ * @file src/lemlib/chassis/pathFollower.cpp
+ * @author LemLib Team
+ * @brief Pure pursuit and RAMSETE path followers
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// The pure pursuit implementation below is mostly based off of
+// the document written by Dawgma
+// Here is a link to the original document
+// https://www.chiefdelphi.com/uploads/default/original/3X/b/e/be0e06de00e07db66f97686505c3f4dde2e332dc.pdf
+
+// The RAMSETE controller is the nonlinear unicycle feedback law from
+// "Control of Wheeled Mobile Robots: An Experimental Overview" by Samson et al.,
+// in the form used by FRC teams and WPILib
+
+#include "lemlib/chassis/pathFollower.hpp"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "lemlib/chassis/motionControl.hpp"
+#include "lemlib/util.hpp"
+
+namespace {
+/**
+ * @brief Get the power for one side of the drivetrain to drive its wheels at a velocity
+ *
+ * @param constants the wheel velocity constants. The velocity is scaled to power if kV is 0
+ * @param maxVel the max velocity of the drivetrain, in inches per second
+ * @param targetVelocity the target velocity of the wheels, in inches per second
+ * @param prevVelocity the target velocity of the last update, in inches per second
+ * @param velocity the measured velocity of the wheels, in inches per second
+ * @param dt time since the last update, in seconds. The target acceleration is 0 if it is 0
+ * @return float power out of 127
+ */
+float followerPower(const lemlib::VelocityController_t& constants, float maxVel, float targetVelocity,
+                    float prevVelocity, float velocity, float dt) {
+  if (constants.kV == 0) return targetVelocity * 127 / maxVel;
+  float acceleration = (dt > 0) ? (targetVelocity - prevVelocity) / dt : 0;
+  return lemlib::wheelPower(constants, targetVelocity, acceleration, velocity);
+}
+}  // namespace
+
+/**
+ * @brief find the closest point on the path to the robot
+ *
+ * @param pose the current pose of the robot
+ * @param path the path to follow
+ * @return int index to the closest point
+ */
+int lemlib::findClosest(Pose pose, const std::vector<Pose>& path) {
+  int closestPoint = 0;
+  float closestDist = 1000000;
+  float dist;
+
+  // loop through all path points
+  for (int i = 0; i < path.size(); i++) {
+    dist = pose.distance(path.at(i));
+    if (dist < closestDist) {  // new closest point
+      closestDist = dist;
+      closestPoint = i;
+    }
+  }
+
+  return closestPoint;
+}
+
+/**
+ * @brief Function that finds the intersection point between a circle and a line
+ *
+ * @param p1 start point of the line
+ * @param p2 end point of the line
+ * @param pose position of the robot
+ * @param lookaheadDist the radius of the circle around the robot
+ * @return float how far along the line the intersection is, between 0 and 1. -1 if there is none
+ */
+float lemlib::circleIntersect(Pose p1, Pose p2, Pose pose, float lookaheadDist) {
+  // calculations
+  // uses the quadratic formula to calculate intersection points
+  Pose d = p2 - p1;
+  Pose f = p1 - pose;
+  float a = d * d;
+  float b = 2 * (f * d);
+  float c = (f * f) - lookaheadDist * lookaheadDist;
+  float discriminant = b * b - 4 * a * c;
+
+  // if a possible intersection was found
+  if (discriminant >= 0) {
+    discriminant = sqrt(discriminant);
+    float t1 = (-b - discriminant) / (2 * a);
+    float t2 = (-b + discriminant) / (2 * a);
+
+    // prioritize further down the path
+    if (t2 >= 0 && t2 <= 1) return t2;
+    else if (t1 >= 0 && t1 <= 1) return t1;
+  }
+
+  // no intersection found
+  return -1;
+}
+
+/**
+ * @brief returns the lookahead point
+ *
+ * @param lastLookahead the last lookahead point. Its theta is the index of the segment it is on
+ * @param pose the current position of the robot
+ * @param path the path to follow
+ * @param lookaheadDist the lookahead distance
+ * @return Pose the lookahead point. Its theta is the index of the segment it is on
+ */
+lemlib::Pose lemlib::lookaheadPoint(Pose lastLookahead, Pose pose, const std::vector<Pose>& path,
+                                    float lookaheadDist) {
+  // initialize variables
+  Pose lookahead = lastLookahead;
+  double t;
+
+  // find the furthest lookahead point on the path
+  for (int i = 0; i < path.size() - 1; i++) {
+    t = circleIntersect(path.at(i), path.at(i + 1), pose, lookaheadDist);
+    if (t != -1 && i >= lastLookahead.theta) {  // new lookahead point found
+      lookahead = Pose(path.at(i)).lerp(path.at(i + 1), t);
+      lookahead.theta = i;
+    }
+  }
+
+  return lookahead;
+}
+
+/**
+ * @brief Get the curvature of a circle that intersects the robot and the lookahead point
+ *
+ * @param pose the position of the robot
+ * @param heading the heading of the robot
+ * @param lookahead the lookahead point
+ * @return double curvature
+ */
+double lemlib::findLookaheadCurvature(Pose pose, double heading, Pose lookahead) {
+  // calculate whether the robot is on the left or right side of the circle
+  double side = sgn(std::sin(heading) * (lookahead.x - pose.x) - std::cos(heading) * (lookahead.y - pose.y));
+  // calculate center point and radius
+  double a = -std::tan(heading);
+  double c = std::tan(heading) * pose.x - pose.y;
+  double x = std::fabs(a * lookahead.x + lookahead.y + c) / std::sqrt((a * a) + 1);
+  double d = std::hypot(lookahead.x - pose.x, lookahead.y - pose.y);
+
+  // return curvature
+  return side * ((2 * x) / (d * d));
+}
+
+/**
+ * @brief Calculate the lookahead distance for the adaptive lookahead
+ *
+ * @param settings the follow settings
+ * @param velocity the current velocity of the robot, in inches per second
+ * @param closestPoint index of the closest point on the path
+ * @param path the path to follow
+ * @param curvatures curvature of the path at each point
+ * @return float lookahead distance in inches
+ */
+float lemlib::adaptiveLookahead(FollowSettings_t settings, float velocity, int closestPoint,
+                                const std::vector<Pose>& path, const std::vector<float>& curvatures) {
+  // find the sharpest curve within the longest lookahead distance
+  float maxCurvature = 0;
+  float dist = 0;
+  for (int i = closestPoint; i < path.size() - 1 && dist < settings.maxLookahead; i++) {
+    maxCurvature = std::max(maxCurvature, curvatures.at(i));
+    dist += Pose(path.at(i)).distance(path.at(i + 1));
+  }
+
+  // scale with velocity, then shrink in curves
+  float lookahead = settings.minLookahead + settings.lookaheadTime * std::fabs(velocity);
+  lookahead /= 1 + settings.curvatureGain * maxCurvature;
+  return std::max(settings.minLookahead, std::min(settings.maxLookahead, lookahead));
+}
+
+/**
+ * @brief Sample a trajectory at a point in time
+ *
+ * @param trajectory the trajectory
+ * @param index index of the last sampled segment. Updated to the segment containing time
+ * @param time time since the start of the trajectory, in seconds
+ * @return TrajectoryPoint_t the interpolated point
+ */
+lemlib::TrajectoryPoint_t lemlib::sampleTrajectory(const std::vector<TrajectoryPoint_t>& trajectory, int& index,
+                                                   float time) {
+  // time only moves forward, so the search starts at the last segment
+  while (index < (int)trajectory.size() - 1 && trajectory.at(index + 1).time <= time) index++;
+  if (index >= (int)trajectory.size() - 1) return trajectory.back();
+
+  const TrajectoryPoint_t& a = trajectory.at(index);
+  const TrajectoryPoint_t& b = trajectory.at(index + 1);
+  float t = (b.time > a.time) ? (time - a.time) / (b.time - a.time) : 0;
+  TrajectoryPoint_t point;
+  point.x = a.x + (b.x - a.x) * t;
+  point.y = a.y + (b.y - a.y) * t;
+  point.theta = a.theta + angleError(b.theta, a.theta, true) * t;
+  point.velocity = a.velocity + (b.velocity - a.velocity) * t;
+  point.angularVelocity = a.angularVelocity;
+  point.time = time;
+  return point;
+}
+
+/**
+ * @brief Construct a new Pure Pursuit follower
+ *
+ * @param path the path, profiled by profilePath()
+ * @param drivetrain the drivetrain
+ * @param followSettings the follow settings
+ * @param velocitySettings the wheel velocity constants. Velocities are scaled to power if kV is 0
+ * @param lookahead the lookahead distance in inches. 0 for the adaptive lookahead, see Chassis::follow()
+ * @param reverse whether the robot follows the path in reverse
+ * @param maxSpeed the maximum speed the robot can move at
+ */
+lemlib::PurePursuit::PurePursuit(const std::vector<Pose>& path, Drivetrain_t drivetrain,
+                                 FollowSettings_t followSettings, VelocityController_t velocitySettings,
+                                 float lookahead, bool reverse, float maxSpeed)
+    : path(path),
+      drivetrain(drivetrain),
+      followSettings(followSettings),
+      velocitySettings(velocitySettings),
+      lookahead(lookahead),
+      adaptive(lookahead == 0 && followSettings.maxLookahead != 0),
+      reverse(reverse),
+      maxSpeed(maxSpeed),
+      lastLookahead(path.at(0)) {
+  // a lookahead circle without a radius never reaches the path ahead of the robot
+  if (!adaptive && this->lookahead <= 0) {
+    this->lookahead = (followSettings.minLookahead > 0) ? followSettings.minLookahead : 15;
+  }
+  if (adaptive) {
+    for (int i = 0; i < path.size(); i++) curvatures.push_back(pathCurvature(path, i));
+  }
+  lastLookahead.theta = 0;
+}
+
+/**
+ * @brief Update the follower
+ *
+ * @param pose the pose of the robot, with theta in radians
+ * @param dt time since the last update, in seconds. Ignored on the first update
+ * @param leftVelocity measured velocity of the left wheels, in inches per second
+ * @param rightVelocity measured velocity of the right wheels, in inches per second
+ * @return true - the robot is following the path
+ * @return false - the robot has reached the end of the path
+ */
+bool lemlib::PurePursuit::update(Pose pose, float dt, float leftVelocity, float rightVelocity) {
+  if (reverse) pose.theta -= M_PI;
+  if (!started) {
+    prevPose = pose;
+    dt = 0;
+  }
+  started = true;
+
+  // estimate the velocity of the robot, filtered to smooth out odometry noise
+  if (dt > 0) velocity = 0.7 * velocity + 0.3 * pose.distance(prevPose) / dt;
+  prevPose = pose;
+
+  // find the closest point on the path to the robot
+  int closestPoint = findClosest(pose, path);
+  // if the robot is at the end of the path, then stop
+  if (path.at(closestPoint).theta == 0) return false;
+
+  // find the lookahead point
+  if (adaptive) lookahead = adaptiveLookahead(followSettings, velocity, closestPoint, path, curvatures);
+  Pose lookaheadPose = lookaheadPoint(lastLookahead, pose, path, lookahead);
+  lastLookahead = lookaheadPose;  // update last lookahead position
+
+  // get the curvature of the arc between the robot and the lookahead point
+  double curvatureHeading = M_PI / 2 - pose.theta;
+  double curvature = findLookaheadCurvature(pose, curvatureHeading, lookaheadPose);
+
+  // get the target velocity of the robot
+  float targetVel = path.at(closestPoint).theta;
+
+  // calculate target left and right velocities
+  float targetLeftVel = targetVel * (2 + curvature * drivetrain.trackWidth) / 2;
+  float targetRightVel = targetVel * (2 - curvature * drivetrain.trackWidth) / 2;
+
+  // ratio the speeds to respect the max speed
+  const float maxVel = maxVelocity(drivetrain);
+  float ratio = std::max(std::fabs(targetLeftVel), std::fabs(targetRightVel)) / (maxSpeed * maxVel / 127);
+  if (ratio > 1) {
+    targetLeftVel /= ratio;
+    targetRightVel /= ratio;
+  }
+
+  // swap and negate the sides if the robot is following the path in reverse
+  float leftVel = reverse ? -targetRightVel : targetLeftVel;
+  float rightVel = reverse ? -targetLeftVel : targetRightVel;
+
+  // convert the velocities to motor power
+  leftPower = followerPower(velocitySettings, maxVel, leftVel, prevLeftVel, leftVelocity, dt);
+  rightPower = followerPower(velocitySettings, maxVel, rightVel, prevRightVel, rightVelocity, dt);
+  prevLeftVel = leftVel;
+  prevRightVel = rightVel;
+  return true;
+}
+
+/**
+ * @brief Get the output for the left side of the drivetrain
+ *
+ * @return float power out of 127
+ */
+float lemlib::PurePursuit::getLeftPower() { return leftPower; }
+
+/**
+ * @brief Get the output for the right side of the drivetrain
+ *
+ * @return float power out of 127
+ */
+float lemlib::PurePursuit::getRightPower() { return rightPower; }
+
+/**
+ * @brief Construct a new Ramsete follower
+ *
+ * @param trajectory the trajectory, from timeParameterize()
+ * @param drivetrain the drivetrain
+ * @param followSettings the follow settings. The RAMSETE gains default to b = 0.0013 and zeta = 0.7 if they are 0
+ * @param velocitySettings the wheel velocity constants. Velocities are scaled to power if kV is 0
+ * @param reverse whether the robot follows the path in reverse
+ * @param maxSpeed the maximum speed the robot can move at
+ * @param endTolerance how far along the path from its last point the robot can stop, in inches
+ */
+lemlib::Ramsete::Ramsete(const std::vector<TrajectoryPoint_t>& trajectory, Drivetrain_t drivetrain,
+                         FollowSettings_t followSettings, VelocityController_t velocitySettings, bool reverse,
+                         float maxSpeed, float endTolerance)
+    : trajectory(trajectory),
+      drivetrain(drivetrain),
+      velocitySettings(velocitySettings),
+      b((followSettings.ramseteB != 0) ? followSettings.ramseteB : 0.0013),
+      zeta((followSettings.ramseteZeta != 0) ? followSettings.ramseteZeta : 0.7),
+      reverse(reverse),
+      maxSpeed(maxSpeed),
+      endTolerance(endTolerance) {}
+
+/**
+ * @brief Update the follower
+ *
+ * @param pose the pose of the robot, with theta in radians
+ * @param time time since the start of the trajectory, in seconds
+ * @param leftVelocity measured velocity of the left wheels, in inches per second
+ * @param rightVelocity measured velocity of the right wheels, in inches per second
+ * @return true - the robot is following the trajectory
+ * @return false - the trajectory is done, and the robot is within the end tolerance of its last point
+ */
+bool lemlib::Ramsete::update(Pose pose, float time, float leftVelocity, float rightVelocity) {
+  // past the end of the trajectory, the target is its last point, at rest
+  const bool ended = time > trajectory.back().time;
+  TrajectoryPoint_t target = sampleTrajectory(trajectory, index, time);
+  if (ended) {
+    target.velocity = 0;
+    target.angularVelocity = 0;
+  }
+  if (reverse) pose.theta += M_PI;
+
+  // error in the frame of the robot. Headings are converted from clockwise-from-y to counterclockwise-from-x
+  float theta = M_PI_2 - pose.theta;
+  float deltaX = target.x - pose.x;
+  float deltaY = target.y - pose.y;
+  float errorX = std::cos(theta) * deltaX + std::sin(theta) * deltaY;
+  float errorY = -std::sin(theta) * deltaX + std::cos(theta) * deltaY;
+  float errorTheta = std::remainder(pose.theta - target.theta, 2 * M_PI);  // counterclockwise error
+  float targetAngular = -target.angularVelocity;
+  // the robot can't drive sideways, so the trajectory is done once the robot is level with its last point
+  if (ended && std::fabs(errorX) < endTolerance) return false;
+
+  // RAMSETE control law
+  const float maxVel = maxVelocity(drivetrain);
+  float k = 2 * zeta * std::sqrt(targetAngular * targetAngular + b * target.velocity * target.velocity);
+  // the gain is 0 at rest, so past the end it is held at its value at the max velocity to drive onto the last point
+  if (ended) k = std::max(k, 2 * zeta * std::sqrt(b) * maxVel);
+  float sinc = (std::fabs(errorTheta) < 1e-4) ? 1 : std::sin(errorTheta) / errorTheta;
+  float linear = target.velocity * std::cos(errorTheta) + k * errorX;
+  float angular = targetAngular + k * errorTheta + b * target.velocity * sinc * errorY;
+
+  // calculate target left and right velocities
+  float targetLeftVel = linear - angular * drivetrain.trackWidth / 2;
+  float targetRightVel = linear + angular * drivetrain.trackWidth / 2;
+
+  // ratio the speeds to respect the max speed
+  float ratio = std::max(std::fabs(targetLeftVel), std::fabs(targetRightVel)) / (maxSpeed * maxVel / 127);
+  if (ratio > 1) {
+    targetLeftVel /= ratio;
+    targetRightVel /= ratio;
+  }
+
+  // swap and negate the sides if the robot is following the path in reverse
+  float leftVel = reverse ? -targetRightVel : targetLeftVel;
+  float rightVel = reverse ? -targetLeftVel : targetRightVel;
+
+  // convert the velocities to motor power
+  leftPower = followerPower(velocitySettings, maxVel, leftVel, prevLeftVel, leftVelocity, time - prevTime);
+  rightPower = followerPower(velocitySettings, maxVel, rightVel, prevRightVel, rightVelocity, time - prevTime);
+  prevLeftVel = leftVel;
+  prevRightVel = rightVel;
+  prevTime = time;
+  return true;
+}
+
+/**
+ * @brief Get the output for the left side of the drivetrain
+ *
+ * @return float power out of 127
+ */
+float lemlib::Ramsete::getLeftPower() { return leftPower; }
+
+/**
+ * @brief Get the output for the right side of the drivetrain
+ *
+ * @return float power out of 127
+ */
+float lemlib::Ramsete::getRightPower() { return rightPower; }
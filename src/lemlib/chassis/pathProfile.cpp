@@ -0,0 +1,202 @@
+/**
+ * @file src/lemlib/chassis/pathProfile.cpp
+ * @author LemLib Team
+ * @brief Velocity profiling for paths followed by the chassis
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// The profile follows the approach in the document written by Dawgma
+// (the same document pure pursuit is based on): cap each point by the curvature of
+// the path, then limit acceleration with a forward pass and deceleration with a backward pass
+
+#include "lemlib/chassis/pathProfile.hpp"
+
+#include <math.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include "lemlib/util.hpp"
+
+/**
+ * @brief function that returns elements in a file line, separated by a delimeter
+ *
+ * @param input the raw string
+ * @param delimeter string separating the elements in the line
+ * @return std::vector<std::string> array of elements read from the file
+ */
+std::vector<std::string> readElement(std::string input, std::string delimiter) {
+  std::string token;
+  std::string s = input;
+  std::vector<std::string> output;
+  size_t pos = 0;
+
+  // main loop
+  while ((pos = s.find(delimiter)) != std::string::npos) {  // while there are still delimiters in the string
+    token = s.substr(0, pos);                                // processed substring
+    output.push_back(token);
+    s.erase(0, pos + delimiter.length());  // remove the read substring
+  }
+
+  if (s.length() > 1) s.pop_back();  // delete the endline character at the end of the string
+  output.push_back(s);               // add the last element to the returned string
+
+  return output;
+}
+
+/**
+ * @brief Get a path from the sd card
+ *
+ * @param filePath The file to read from
+ * @return std::vector<lemlib::Pose> vector of points on the path
+ */
+std::vector<lemlib::Pose> lemlib::getData(std::string filePath) {
+  std::vector<lemlib::Pose> robotPath;
+  std::string line;
+  std::vector<std::string> pointInput;
+  std::ifstream file(filePath, std::ios::in);
+  lemlib::Pose pathPoint(0, 0, 0);
+
+  // read the points until 'endData' is read
+  while (getline(file, line) && line != "endData") {
+    pointInput = readElement(line, ", ");           // parse line
+    pathPoint.x = std::stof(pointInput.at(0));      // x position
+    pathPoint.y = std::stof(pointInput.at(1));      // y position
+    pathPoint.theta = std::stof(pointInput.at(2));  // velocity
+    robotPath.push_back(pathPoint);                 // save data
+  }
+
+  file.close();
+  return robotPath;
+}
+
+/**
+ * @brief Get the maximum velocity of the drivetrain
+ *
+ * @param drivetrain the drivetrain
+ * @return float maximum velocity in inches per second. Theoretical maximum if maxVelocity is not set
+ */
+float lemlib::maxVelocity(Drivetrain_t drivetrain) {
+  if (drivetrain.maxVelocity != 0) return drivetrain.maxVelocity;
+  return drivetrain.wheelDiameter * M_PI * drivetrain.rpm / 60;
+}
+
+/**
+ * @brief Get the curvature of the path at a point
+ *
+ * @param path the path
+ * @param index index of the point
+ * @return float curvature in 1/inches, always positive
+ */
+float lemlib::pathCurvature(const std::vector<Pose>& path, int index) {
+  if (index <= 0 || index >= (int)path.size() - 1) return 0;
+  const Pose& p1 = path.at(index - 1);
+  const Pose& p2 = path.at(index);
+  const Pose& p3 = path.at(index + 1);
+
+  // curvature of the circle passing through all 3 points: 4 * area / (a * b * c)
+  float a = std::hypot(p2.x - p1.x, p2.y - p1.y);
+  float b = std::hypot(p3.x - p2.x, p3.y - p2.y);
+  float c = std::hypot(p3.x - p1.x, p3.y - p1.y);
+  float cross = (p2.x - p1.x) * (p3.y - p1.y) - (p2.y - p1.y) * (p3.x - p1.x);
+  if (a * b * c == 0) return 0;  // duplicate points
+  return 2 * std::fabs(cross) / (a * b * c);
+}
+
+/**
+ * @brief Generate the velocity profile of a path
+ *
+ * @param path the path to profile
+ * @param drivetrain the drivetrain constraints to respect
+ */
+void lemlib::profilePath(std::vector<Pose>& path, Drivetrain_t drivetrain) {
+  if (path.empty()) return;
+  const float maxVel = maxVelocity(drivetrain);
+  const int last = path.size() - 1;
+
+  // no constraints, keep the velocities from the path file
+  if (drivetrain.maxAcceleration == 0 && drivetrain.maxDeceleration == 0 && drivetrain.maxLateralAccel == 0) {
+    for (Pose& point : path) point.theta = point.theta * maxVel / 127;
+    return;
+  }
+
+  // limit each point by the max velocity and the curvature of the path
+  for (int i = 0; i <= last; i++) {
+    float curvature = pathCurvature(path, i);
+    float vel = maxVel / (1 + curvature * drivetrain.trackWidth / 2);  // the outer wheel can't exceed max velocity
+    if (drivetrain.maxLateralAccel != 0 && curvature != 0)
+      vel = std::min(vel, (float)std::sqrt(drivetrain.maxLateralAccel / curvature));
+    path.at(i).theta = vel;
+  }
+  path.at(last).theta = 0;  // the end of the path is marked by a velocity of 0
+
+  // forward pass, limit acceleration
+  // the first point is seeded with the velocity reached at the end of the first segment so the robot starts moving
+  if (drivetrain.maxAcceleration != 0) {
+    float prevVel = 0;
+    for (int i = 0; i < last; i++) {
+      float dist = path.at(i).distance(path.at(i + 1));
+      float reachable = std::sqrt(prevVel * prevVel + 2 * drivetrain.maxAcceleration * dist);
+      path.at(i).theta = std::min(path.at(i).theta, reachable);
+      prevVel = path.at(i).theta;
+    }
+  }
+
+  // backward pass, limit deceleration
+  if (drivetrain.maxDeceleration != 0) {
+    for (int i = last - 1; i >= 0; i--) {
+      float dist = path.at(i).distance(path.at(i + 1));
+      float reachable = std::sqrt(path.at(i + 1).theta * path.at(i + 1).theta + 2 * drivetrain.maxDeceleration * dist);
+      path.at(i).theta = std::min(path.at(i).theta, reachable);
+    }
+  }
+}
+
+/**
+ * @brief Time-parameterize a profiled path
+ *
+ * @param path the profiled path
+ * @return std::vector<TrajectoryPoint_t> the trajectory
+ */
+std::vector<lemlib::TrajectoryPoint_t> lemlib::timeParameterize(std::vector<Pose>& path) {
+  std::vector<TrajectoryPoint_t> trajectory;
+  float time = 0;
+  for (int i = 0; i < path.size(); i++) {
+    TrajectoryPoint_t point;
+    point.x = path.at(i).x;
+    point.y = path.at(i).y;
+    point.velocity = path.at(i).theta;
+    point.time = time;
+    // the heading is the direction of the next segment. The last point keeps the heading of the last segment
+    if (i < path.size() - 1) {
+      point.theta = std::atan2(path.at(i + 1).x - path.at(i).x, path.at(i + 1).y - path.at(i).y);
+    } else if (i > 0) {
+      point.theta = trajectory.back().theta;
+    } else {
+      point.theta = 0;
+    }
+    point.angularVelocity = 0;
+    trajectory.push_back(point);
+
+    // time to reach the next point, assuming constant acceleration along the segment
+    if (i < path.size() - 1) {
+      float dist = path.at(i).distance(path.at(i + 1));
+      float avgVel = (path.at(i).theta + path.at(i + 1).theta) / 2;
+      time += (avgVel > 0) ? dist / avgVel : 0;
+    }
+  }
+
+  // the angular velocity is the change in heading over the time to the next point
+  for (int i = 0; i < (int)trajectory.size() - 1; i++) {
+    float dt = trajectory.at(i + 1).time - trajectory.at(i).time;
+    if (dt > 0) {
+      trajectory.at(i).angularVelocity = angleError(trajectory.at(i + 1).theta, trajectory.at(i).theta, true) / dt;
+    }
+  }
+  return trajectory;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file src/lemlib/chassis/ramsete.cpp
+ * @author LemLib Team
+ * @brief RAMSETE trajectory follower implementation
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// The follower is in pathFollower.cpp, this file runs it on the robot
+
+#include <string>
+#include <vector>
+
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/pathFollower.hpp"
+#include "lemlib/chassis/pathProfile.hpp"
+#include "lemlib/chassis/wheelController.hpp"
+#include "lemlib/util.hpp"
+#include "pros/misc.hpp"
+
+/**
+ * @brief Move the chassis along a path with a RAMSETE controller
+ *
+ * @param filePath file path to the path. No need to preface it with /usd/
+ * @param timeout the maximum time the robot can spend moving
+ * @param reverse whether the robot should follow the path in reverse. false by default
+ * @param maxSpeed the maximum speed the robot can move at
+ * @param async whether the function should return immediately and run the motion on the motion task
+ */
+void lemlib::Chassis::ramsete(const char* filePath, int timeout, bool reverse, float maxSpeed, bool async) {
+  // queue the motion on the motion task if it is asynchronous
+  if (async) {
+    std::string file = filePath;  // copy the file path, the caller's string may not outlive the motion
+    queueMotion([=] { ramsete(file.c_str(), timeout, reverse, maxSpeed, false); });
+    return;
+  }
+  startMotion();
+  std::vector<lemlib::Pose> path = lemlib::getData("/usd/" + std::string(filePath));  // get list of path points
+  lemlib::profilePath(path, drivetrain);  // generate the velocity profile, in inches per second
+  std::vector<TrajectoryPoint_t> trajectory = lemlib::timeParameterize(path);
+  Ramsete follower(trajectory, drivetrain, followSettings, velocitySettings, reverse, maxSpeed,
+                   lateralSettings.smallError);
+  WheelController leftController(velocitySettings, drivetrain.leftMotors, drivetrain.wheelDiameter, drivetrain.rpm);
+  WheelController rightController(velocitySettings, drivetrain.rightMotors, drivetrain.wheelDiameter, drivetrain.rpm);
+  // the measured wheel velocities are only used by the feedback of the wheel velocity controller
+  const bool feedback = velocitySettings.kV != 0 && velocitySettings.kP != 0;
+  Pose prevPose = getPose(true);
+  int start = pros::millis();
+  int compState = pros::competition::get_status();
+
+  // loop until the robot reaches the end of the trajectory
+  while (pros::millis() - start < timeout && pros::competition::get_status() == compState && !motionCanceled) {
+    // get the current position of the robot
+    Pose pose = getPose(true);
+    distTravelled = distTravelled + pose.distance(prevPose);
+    prevPose = pose;
+
+    float leftVelocity = feedback ? leftController.getVelocity() : 0;
+    float rightVelocity = feedback ? rightController.getVelocity() : 0;
+    if (!follower.update(pose, (pros::millis() - start) / 1000.0, leftVelocity, rightVelocity)) break;
+
+    // move the drivetrain
+    drivetrain.leftMotors->move(follower.getLeftPower());
+    drivetrain.rightMotors->move(follower.getRightPower());
+
+    pros::delay(10);
+  }
+
+  // stop the robot
+  stop();
+  endMotion();
+}
@@ -0,0 +1,84 @@
+/**
+ * @file src/lemlib/chassis/wheelController.cpp
+ * @author LemLib Team
+ * @brief Wheel velocity controller definitions
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/chassis/wheelController.hpp"
+
+#include <math.h>
+
+#include "lemlib/chassis/motionControl.hpp"
+
+/**
+ * @brief Construct a new Wheel Controller
+ *
+ * @param constants the feedforward and feedback constants
+ * @param motors the motor group driving the wheels
+ * @param wheelDiameter the diameter of the wheels in inches
+ * @param rpm the rpm of the wheels
+ */
+lemlib::WheelController::WheelController(VelocityController_t constants, pros::Motor_Group* motors,
+                                         float wheelDiameter, float rpm) {
+  this->constants = constants;
+  this->motors = motors;
+  this->wheelDiameter = wheelDiameter;
+  this->rpm = rpm;
+}
+
+/**
+ * @brief Get the velocity of the wheels, measured by the motors
+ *
+ * @return float velocity in inches per second
+ */
+float lemlib::WheelController::getVelocity() {
+  // read each motor directly so no vectors are allocated in the control loop
+  float total = 0;
+  int count = motors->size();
+  for (int i = 0; i < count; i++) total += (*motors)[i].get_actual_velocity() * (rpm / cartridgeRpm((*motors)[i]));
+  if (count == 0) return 0;
+  return (total / count) * wheelDiameter * M_PI / 60;
+}
+
+/**
+ * @brief Update the controller
+ *
+ * @param targetVelocity the target wheel velocity in inches per second
+ * @param targetAcceleration the target wheel acceleration in inches per second squared
+ * @return float - power to send to the motors, out of 127
+ */
+float lemlib::WheelController::update(float targetVelocity, float targetAcceleration) {
+  // the motors are only read for the feedback
+  return wheelPower(constants, targetVelocity, targetAcceleration, (constants.kP != 0) ? getVelocity() : 0);
+}
+
+/**
+ * @brief Drive the wheels at a velocity with the velocity controllers built into the motors
+ *
+ * @param velocity the target wheel velocity in inches per second
+ */
+void lemlib::WheelController::moveVelocity(float velocity) {
+  float wheelRpm = velocity * 60 / (wheelDiameter * M_PI);
+  int count = motors->size();
+  for (int i = 0; i < count; i++) (*motors)[i].move_velocity(wheelRpm * cartridgeRpm((*motors)[i]) / rpm);
+}
+
+/**
+ * @brief Get the rpm of the cartridge of a motor
+ *
+ * @param motor the motor
+ * @return float rpm of the cartridge
+ */
+float lemlib::WheelController::cartridgeRpm(pros::Motor& motor) {
+  switch (motor.get_gearing()) {
+    case pros::E_MOTOR_GEARSET_36: return 100;
+    case pros::E_MOTOR_GEARSET_18: return 200;
+    case pros::E_MOTOR_GEARSET_06: return 600;
+    default: return 200;
+  }
+}
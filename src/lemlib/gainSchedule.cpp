@@ -0,0 +1,82 @@
+/**
+ * @file src/lemlib/gainSchedule.cpp
+ * @author LemLib Team
+ * @brief Gain schedule definitions
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/gainSchedule.hpp"
+
+#include <math.h>
+
+/**
+ * @brief Construct a new Gain Schedule
+ *
+ * @param errorStep the difference in error between the columns of the table. The first column is an error of 0
+ * @param minVoltage the battery voltage of the first row of the table, in volts
+ * @param voltageStep the difference in battery voltage between the rows of the table, in volts
+ * @param table the gains, one row per battery voltage, each with one column per error
+ */
+lemlib::GainSchedule::GainSchedule(float errorStep, float minVoltage, float voltageStep,
+                                   std::vector<std::vector<Gains_t>> table) {
+  this->errorStep = errorStep;
+  this->minVoltage = minVoltage;
+  this->voltageStep = voltageStep;
+  this->rows = table.size();
+  this->columns = (rows > 0) ? table.at(0).size() : 0;
+  // flatten the table, so a lookup does not have to follow a pointer for each row
+  for (const std::vector<Gains_t>& row : table) {
+    for (int column = 0; column < columns; column++) this->table.push_back(row.at(column));
+  }
+}
+
+/**
+ * @brief Get the gains for an error and battery voltage
+ *
+ * @param error the error. Only the magnitude is used
+ * @param voltage the battery voltage, in volts
+ * @return Gains_t the interpolated gains
+ */
+lemlib::Gains_t lemlib::GainSchedule::get(float error, float voltage) {
+  if (rows == 0 || columns == 0) return {0, 0};
+  int column, row;
+  float columnT, rowT;
+  locate((errorStep != 0) ? std::fabs(error) / errorStep : 0, columns, column, columnT);
+  locate((voltageStep != 0) ? (voltage - minVoltage) / voltageStep : 0, rows, row, rowT);
+  int nextColumn = (column + 1 < columns) ? column + 1 : column;
+  int nextRow = (row + 1 < rows) ? row + 1 : row;
+
+  // bilinear interpolation between the four surrounding points
+  const Gains_t& a = table[row * columns + column];
+  const Gains_t& b = table[row * columns + nextColumn];
+  const Gains_t& c = table[nextRow * columns + column];
+  const Gains_t& d = table[nextRow * columns + nextColumn];
+  float kP = (a.kP + (b.kP - a.kP) * columnT) * (1 - rowT) + (c.kP + (d.kP - c.kP) * columnT) * rowT;
+  float kD = (a.kD + (b.kD - a.kD) * columnT) * (1 - rowT) + (c.kD + (d.kD - c.kD) * columnT) * rowT;
+  return {kP, kD};
+}
+
+/**
+ * @brief Find the index of the point below a value, and how far the value is towards the next point
+ *
+ * @param position the value in units of the spacing between the points
+ * @param size number of points
+ * @param index output index of the point below the value
+ * @param t output fraction of the way to the next point
+ */
+void lemlib::GainSchedule::locate(float position, int size, int& index, float& t) {
+  if (position <= 0) {  // before the first point
+    index = 0;
+    t = 0;
+  } else if (position >= size - 1) {  // after the last point
+    index = size - 1;
+    t = 0;
+  } else {
+    index = position;
+    t = position - index;
+  }
+}
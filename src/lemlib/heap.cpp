@@ -0,0 +1,221 @@
+/**
+ * @file src/lemlib/heap.cpp
+ * @author LemLib Team
+ * @brief Heap allocation tracking, and a guard that reports allocations after initialization
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/heap.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+#include "lemlib/taskTable.hpp"
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+
+// Everything here runs inside operator new and malloc, so none of it may allocate. Counters are atomics, and tasks
+// claim their slot in the task table with a compare and swap, so allocating never waits on a lock either
+
+// the allocator of newlib, which the linker calls malloc and free once they are wrapped
+extern "C" {
+void* __real_malloc(std::size_t size);
+void __real_free(void* memory);
+}
+
+namespace {
+/**
+ * @brief Allocations made by a task
+ */
+struct TaskCount {
+  std::atomic<std::uint32_t> allocations {0};
+  std::atomic<std::uint32_t> bytes {0};
+};
+
+/**
+ * @brief An allocation reported by the guard
+ */
+struct Violation {
+  std::uint32_t time;
+  std::uint32_t size;
+  int task;  // index in the task table
+  lemlib::heap::Phase phase;
+};
+
+std::atomic<std::uint32_t> phaseAllocations[4] = {};
+std::atomic<std::uint32_t> phaseBytes[4] = {};
+// the first counts are for allocations made before the scheduler starts, the rest are for the slots of taskTable
+lemlib::TaskTable<lemlib::heap::MAX_TASKS - 1> taskTable;
+TaskCount tasks[lemlib::heap::MAX_TASKS];
+Violation violations[lemlib::heap::MAX_VIOLATIONS];
+std::atomic<std::uint32_t> violationCount {0};
+std::atomic<bool> initialized {false};
+std::atomic<bool> guard {false};
+
+const char* const PHASE_NAMES[] = {"initialize", "disabled", "autonomous", "opcontrol"};
+
+/**
+ * @brief Get the phase the robot is in
+ *
+ * @return lemlib::heap::Phase the phase
+ */
+lemlib::heap::Phase currentPhase() {
+  if (!initialized.load(std::memory_order_relaxed)) return lemlib::heap::Phase::INITIALIZE;
+  std::uint8_t status = pros::competition::get_status();
+  if (status & COMPETITION_DISABLED) return lemlib::heap::Phase::DISABLED;
+  if (status & COMPETITION_AUTONOMOUS) return lemlib::heap::Phase::AUTONOMOUS;
+  return lemlib::heap::Phase::OPCONTROL;
+}
+
+/**
+ * @brief Find the counts of the current task
+ *
+ * @return int index of the counts of the task
+ */
+int currentTask() {
+  if (pros::c::task_get_current() == nullptr) return 0;
+  return 1 + taskTable.find(pros::c::task_get_name(nullptr));
+}
+
+/**
+ * @brief Get the name of the task with some counts
+ *
+ * @param index index of the counts
+ * @return const char* name of the task
+ */
+const char* taskName(int index) { return (index == 0) ? "startup" : taskTable.getName(index - 1); }
+
+/**
+ * @brief Count an allocation, and report it if the guard is enabled
+ *
+ * @param size size of the allocation in bytes
+ */
+void count(std::size_t size) {
+  lemlib::heap::Phase phase = currentPhase();
+  int task = currentTask();
+  phaseAllocations[int(phase)].fetch_add(1, std::memory_order_relaxed);
+  phaseBytes[int(phase)].fetch_add(size, std::memory_order_relaxed);
+  TaskCount& counts = tasks[task];
+  counts.allocations.fetch_add(1, std::memory_order_relaxed);
+  counts.bytes.fetch_add(size, std::memory_order_relaxed);
+
+  if (phase != lemlib::heap::Phase::INITIALIZE && guard.load(std::memory_order_relaxed)) {
+    std::uint32_t index = violationCount.fetch_add(1, std::memory_order_relaxed);
+    if (index < lemlib::heap::MAX_VIOLATIONS) {
+      violations[index] = {pros::millis(), static_cast<std::uint32_t>(size), task, phase};
+    }
+  }
+}
+
+/**
+ * @brief Allocate memory and count the allocation
+ *
+ * @param size size of the allocation in bytes
+ * @return void* the memory, nullptr if there is not enough
+ */
+void* allocate(std::size_t size) {
+  void* memory = __real_malloc(size == 0 ? 1 : size);
+  if (memory != nullptr) count(size);
+  return memory;
+}
+}  // namespace
+
+// wrap malloc and free, so allocations made in C and by libraries that call malloc directly are counted as well.
+// Needs -Wl,--wrap=malloc,--wrap=free, see EXTRA_LDFLAGS in the Makefile. operator new calls the real malloc, so
+// its allocations are counted once
+extern "C" {
+void* __wrap_malloc(std::size_t size) { return allocate(size); }
+
+void __wrap_free(void* memory) { __real_free(memory); }
+}
+
+// replace the global allocation functions, so every allocation made with new (including by std::string,
+// std::vector and std::function) is counted. The aligned versions are left to the standard library
+void* operator new(std::size_t size) {
+  void* memory = allocate(size);
+  if (memory == nullptr) throw std::bad_alloc();
+  return memory;
+}
+
+void* operator new[](std::size_t size) {
+  void* memory = allocate(size);
+  if (memory == nullptr) throw std::bad_alloc();
+  return memory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* memory) noexcept { __real_free(memory); }
+
+void operator delete[](void* memory) noexcept { __real_free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { __real_free(memory); }
+
+void operator delete[](void* memory, std::size_t) noexcept { __real_free(memory); }
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept { __real_free(memory); }
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { __real_free(memory); }
+
+/**
+ * @brief Mark the end of initialize()
+ */
+void lemlib::heap::finishInitialize() { initialized = true; }
+
+/**
+ * @brief Enable or disable the guard
+ *
+ * @param enabled whether the guard is enabled
+ */
+void lemlib::heap::setGuard(bool enabled) { guard = enabled; }
+
+/**
+ * @brief Get the allocations made in a phase
+ *
+ * @param phase the phase
+ * @return AllocationStats_t the allocations
+ */
+lemlib::heap::AllocationStats_t lemlib::heap::getStats(Phase phase) {
+  return {phaseAllocations[int(phase)].load(), phaseBytes[int(phase)].load()};
+}
+
+/**
+ * @brief Get the number of allocations reported by the guard
+ *
+ * @return std::uint32_t the number of violations
+ */
+std::uint32_t lemlib::heap::getViolations() { return violationCount.load(); }
+
+/**
+ * @brief Print the allocations of each phase and task, the size of the heap and the violations of the guard
+ */
+void lemlib::heap::print() {
+  struct mallinfo info = mallinfo();
+  printf("heap: %d bytes in use, %d bytes free\n", info.uordblks, info.fordblks);
+  for (int phase = 0; phase < 4; phase++) {
+    printf("  %-10s %8lu allocations %10lu bytes\n", PHASE_NAMES[phase], (unsigned long)phaseAllocations[phase].load(),
+           (unsigned long)phaseBytes[phase].load());
+  }
+  for (int i = 0; i < MAX_TASKS; i++) {
+    if (tasks[i].allocations.load() == 0) continue;
+    printf("  task %-20s %8lu allocations %10lu bytes\n", taskName(i), (unsigned long)tasks[i].allocations.load(),
+           (unsigned long)tasks[i].bytes.load());
+  }
+  std::uint32_t count = violationCount.load();
+  if (count == 0) return;
+  printf("guard: %lu allocations after initialize()\n", (unsigned long)count);
+  for (std::uint32_t i = 0; i < count && i < MAX_VIOLATIONS; i++) {
+    const Violation& violation = violations[i];
+    printf("  %8lu ms %-10s %6lu bytes in %s\n", (unsigned long)violation.time, PHASE_NAMES[int(violation.phase)],
+           (unsigned long)violation.size, taskName(violation.task));
+  }
+}
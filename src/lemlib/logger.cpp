@@ -9,53 +9,14 @@
  *
  */
 
-#include <iostream>
-#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
 
+#include "lemlib/blackbox.hpp"
 #include "lemlib/logger.hpp"
-
-/**
- * @brief Whether or not to log debug messages.
- *
- * @return true if debug is enabled
- */
-bool lemlib::logger::isDebug() { return lemlib::debug; }
-
-/**
- * @brief Sets lemlib::debug
- *
- * @param debug the new value
- */
-void lemlib::logger::setDebug(bool debug) { lemlib::debug = debug; }
-
-/**
- * @brief Whether or not to log info messages.
- *
- * If false, only log messages with a level of lemlib::logger::Level::WARN
- * or higher will be logged
- */
-bool lemlib::logger::isVerbose() { return lemlib::verbose; }
-
-/**
- * @brief Sets lemlib::verbose
- *
- * @param verbose the new value
- */
-void lemlib::logger::setVerbose(bool verbose) { lemlib::verbose = verbose; }
-
-/**
- * @brief The current lowest log level.
- *
- * @return the lowest loggable level
- */
-lemlib::logger::Level lemlib::logger::getLowestLevel() { return lemlib::logger::lowestLevel; }
-
-/**
- * @brief Sets the lowest loggable level
- *
- * @param level the new lowest loggable level
- */
-void lemlib::logger::setLowestLevel(Level level) { lemlib::logger::lowestLevel = level; }
+#include "pros/rtos.hpp"
 
 /*
 Util functions for logger.
@@ -64,9 +25,9 @@ Not meant to be used outside of this file.
 
 int ordinal(lemlib::logger::Level level) { return static_cast<int>(level); }
 
-const std::string RESET_ANSI = "\033[0m";
+const char* RESET_ANSI = "\033[0m";
 
-std::string getColor(lemlib::logger::Level level) {
+const char* getColor(lemlib::logger::Level level) {
     switch (level) {
         case lemlib::logger::Level::DEBUG: return "\033[0;36m"; // cyan
         case lemlib::logger::Level::INFO: return "\033[0;32m"; // green
@@ -77,27 +38,125 @@ std::string getColor(lemlib::logger::Level level) {
     }
 }
 
-std::string getFormattedLevel(lemlib::logger::Level level) {
-    const char* name = "";
-
+const char* getLevelName(lemlib::logger::Level level) {
     switch (level) {
-        case lemlib::logger::Level::DEBUG: name = "DEBUG"; break;
-        case lemlib::logger::Level::INFO: name = "INFO"; break;
-        case lemlib::logger::Level::WARN: name = "WARN"; break;
-        case lemlib::logger::Level::ERROR: name = "ERROR"; break;
-        case lemlib::logger::Level::FATAL: name = "FATAL"; break;
-        default: name = "UNKNOWN"; break;
+        case lemlib::logger::Level::DEBUG: return "DEBUG";
+        case lemlib::logger::Level::INFO: return "INFO";
+        case lemlib::logger::Level::WARN: return "WARN";
+        case lemlib::logger::Level::ERROR: return "ERROR";
+        case lemlib::logger::Level::FATAL: return "FATAL";
+        default: return "UNKNOWN";
     }
+}
 
-    return getColor(level) + name;
+bool checkLowestLevel(lemlib::logger::Level level) {
+    return ordinal(level) >= ordinal(lemlib::logger::lowestLevel) && level >= lemlib::logger::MIN_LEVEL;
 }
 
-bool checkLowestLevel(lemlib::logger::Level level) { return ordinal(level) >= ordinal(lemlib::logger::lowestLevel); }
+/*
+Ring buffer of formatted messages, printed by a low priority task so logging never waits on the terminal.
+Any task can add messages without locking: a message claims a slot by moving the head forward, and each slot has
+a sequence number that tells whether it is free, being written, or ready to print (a bounded queue by D. Vyukov).
+Sequence numbers are stored relative to the index of the slot, so the zero initialized buffer starts out empty.
+*/
+
+namespace {
+
+constexpr uint32_t CAPACITY = 64; // must be a power of 2
+constexpr uint32_t MASK = CAPACITY - 1;
+constexpr size_t MESSAGE_LENGTH = 128;
+
+struct Slot {
+    std::atomic<uint32_t> sequence;
+    char text[MESSAGE_LENGTH];
+};
+
+Slot slots[CAPACITY];
+std::atomic<uint32_t> head {0}; // position of the next message to be written
+uint32_t tail = 0; // position of the next message to be printed, only used by the drain task
+std::atomic<uint32_t> dropped {0};
+std::atomic<bool> drainStarted {false};
+
+/**
+ * @brief Print every message in the buffer
+ */
+void drain() {
+    uint32_t reportedDropped = 0;
+    while (true) {
+        bool printed = false;
+        while (true) {
+            Slot& slot = slots[tail & MASK];
+            if (slot.sequence.load(std::memory_order_acquire) != (tail & ~MASK) + 1) break; // no message is ready
+            fputs(slot.text, stdout);
+            slot.sequence.store((tail & ~MASK) + CAPACITY, std::memory_order_release); // free the slot
+            tail++;
+            printed = true;
+        }
+        uint32_t totalDropped = dropped.load(std::memory_order_relaxed);
+        if (totalDropped != reportedDropped) {
+            printf("[LemLib] %s%s: %lu log messages dropped, the buffer was full%s\n",
+                   getColor(lemlib::logger::Level::WARN), getLevelName(lemlib::logger::Level::WARN),
+                   (unsigned long)(totalDropped - reportedDropped), RESET_ANSI);
+            reportedDropped = totalDropped;
+            printed = true;
+        }
+        if (printed) fflush(stdout);
+        pros::delay(20);
+    }
+}
+
+/**
+ * @brief Format a message into the buffer, or count it as dropped if the buffer is full
+ *
+ * @param level the level of the message
+ * @param message the message
+ * @param exception the exception, nullptr if there is none
+ */
+void enqueue(lemlib::logger::Level level, const char* message, const char* exception) {
+    // start the drain task the first time a message is logged
+    if (!drainStarted.exchange(true)) {
+        pros::Task task(drain, TASK_PRIORITY_MIN, TASK_STACK_DEPTH_DEFAULT, "LemLib logger");
+    }
+
+    // claim a slot
+    uint32_t position = head.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[position & MASK];
+        int32_t difference = slot->sequence.load(std::memory_order_acquire) - (position & ~MASK);
+        if (difference == 0) { // the slot is free
+            if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        } else if (difference < 0) { // the buffer is full
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else { // another task claimed the slot first
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // format the message, then mark it as ready to print
+    if (exception != nullptr) {
+        snprintf(slot->text, MESSAGE_LENGTH, "[LemLib] %s%s: %s: %s%s\n", getColor(level), getLevelName(level),
+                 message, exception, RESET_ANSI);
+    } else {
+        snprintf(slot->text, MESSAGE_LENGTH, "[LemLib] %s%s: %s%s\n", getColor(level), getLevelName(level), message,
+                 RESET_ANSI);
+    }
+    slot->sequence.store((position & ~MASK) + 1, std::memory_order_release);
+}
+} // namespace
 
 /*
 End of util functions
 */
 
+/**
+ * @brief Get the number of messages dropped because the log buffer was full
+ *
+ * @return the number of dropped messages
+ */
+uint32_t lemlib::logger::getDropped() { return dropped.load(std::memory_order_relaxed); }
+
 /**
  * @brief Logs a message with an exception
  *
@@ -113,9 +172,8 @@ void lemlib::logger::log(Level level, const char* message, const char* exception
     if (message == nullptr) message = "";
     if (exception == nullptr) throw std::invalid_argument("exception cannot be null");
 
-    std::string messageString = "[LemLib] " + getFormattedLevel(level) + ": " + message + ": " + exception + RESET_ANSI;
-
-    std::cout << messageString << std::endl;
+    enqueue(level, message, exception);
+    if (level == Level::FATAL) lemlib::blackbox::dump("fatal error");
 }
 
 /**
@@ -131,58 +189,6 @@ void lemlib::logger::log(Level level, const char* message) {
 
     if (message == nullptr) message = "";
 
-    std::string messageString = "[LemLib] " + getFormattedLevel(level) + ": " + message + RESET_ANSI;
-
-    std::cout << messageString << std::endl;
+    enqueue(level, message, nullptr);
+    if (level == Level::FATAL) lemlib::blackbox::dump("fatal error");
 }
-
-/**
- * @brief Logs a debug message
- *
- * @param message
- */
-void lemlib::logger::debug(const char* message) { log(Level::DEBUG, message); }
-
-/**
- * @brief Logs an info message
- *
- * @param message
- */
-void lemlib::logger::info(const char* message) { log(Level::INFO, message); }
-
-/**
- * @brief Logs a warning message
- *
- * @param message
- */
-void lemlib::logger::warn(const char* message) { log(Level::WARN, message); }
-
-/**
- * @brief Logs an error message
- *
- * @param message
- * @param exception
- */
-void lemlib::logger::error(const char* message, const char* exception) { log(Level::ERROR, message, exception); }
-
-/**
- * @brief Logs an error message
- *
- * @param message
- */
-void lemlib::logger::error(const char* message) { log(Level::ERROR, message); }
-
-/**
- * @brief Logs a fatal message
- *
- * @param message
- * @param exception
- */
-void lemlib::logger::fatal(const char* message, const char* exception) { log(Level::FATAL, message, exception); }
-
-/**
- * @brief Logs a fatal message
- *
- * @param message
- */
-void lemlib::logger::fatal(const char* message) { log(Level::FATAL, message); }
@@ -0,0 +1,62 @@
+/**
+ * @file src/lemlib/loggerConfig.cpp
+ * @author LemLib Team
+ * @brief The logger configuration, shared by every file
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// kept apart from logger.cpp so it does not depend on PROS, and tools/loggerCheck can link it on the host
+
+#include "lemlib/logger.hpp"
+
+// defined once, so every file shares the same configuration
+bool lemlib::debug = false;
+bool lemlib::verbose = false;
+lemlib::logger::Level lemlib::logger::lowestLevel = lemlib::logger::Level::INFO;
+
+/**
+ * @brief Whether or not to log debug messages.
+ *
+ * @return true if debug is enabled
+ */
+bool lemlib::logger::isDebug() { return lemlib::debug; }
+
+/**
+ * @brief Sets lemlib::debug
+ *
+ * @param debug the new value
+ */
+void lemlib::logger::setDebug(bool debug) { lemlib::debug = debug; }
+
+/**
+ * @brief Whether or not to log info messages.
+ *
+ * If false, only log messages with a level of lemlib::logger::Level::WARN
+ * or higher will be logged
+ */
+bool lemlib::logger::isVerbose() { return lemlib::verbose; }
+
+/**
+ * @brief Sets lemlib::verbose
+ *
+ * @param verbose the new value
+ */
+void lemlib::logger::setVerbose(bool verbose) { lemlib::verbose = verbose; }
+
+/**
+ * @brief The current lowest log level.
+ *
+ * @return the lowest loggable level
+ */
+lemlib::logger::Level lemlib::logger::getLowestLevel() { return lemlib::logger::lowestLevel; }
+
+/**
+ * @brief Sets the lowest loggable level
+ *
+ * @param level the new lowest loggable level
+ */
+void lemlib::logger::setLowestLevel(Level level) { lemlib::logger::lowestLevel = level; }
@@ -0,0 +1,268 @@
+/**
+ * @file src/lemlib/monitor.cpp
+ * @author LemLib Team
+ * @brief Task monitor, measures the period, CPU use and free stack of control loops
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/monitor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+#include "lemlib/channels.hpp"
+#include "pros/llemu.hpp"
+#include "pros/rtos.hpp"
+
+// FreeRTOS keeps the smallest amount of free stack each task has had, but PROS does not expose it in its API.
+// Declared weak, so the program still links if the kernel does not export it, and the free stack is reported as
+// unavailable instead
+extern "C" unsigned long uxTaskGetStackHighWaterMark(void* task) __attribute__((weak));
+
+namespace {
+/**
+ * @brief A monitored loop
+ */
+struct Loop {
+  const char* name;
+  int period;
+  // only used by the task of the loop. The task is only compared, never used, since it may have been deleted
+  pros::task_t task = nullptr;
+  std::uint32_t start = 0;
+  bool started = false;
+  // written by the task of the loop, read by the monitor task
+  std::atomic<int> freeStack {-1};  // in words
+  std::atomic<std::uint32_t> iterations {0};
+  std::atomic<std::uint32_t> periodTotal {0};  // in microseconds
+  std::atomic<std::uint32_t> busyTotal {0};  // in microseconds
+  std::atomic<std::uint32_t> maxPeriod {0};  // in microseconds, reset every second by the monitor task
+  std::atomic<std::uint32_t> histogram[lemlib::monitor::HISTOGRAM_BINS] = {};
+  // only used by the monitor task
+  std::uint32_t prevIterations = 0;
+  std::uint32_t prevPeriodTotal = 0;
+  std::uint32_t prevBusyTotal = 0;
+  // updated every second by the monitor task, protected by statsMutex
+  float meanPeriod = 0;
+  float maxPeriodMs = 0;
+  float cpu = 0;
+  int stack = -1;
+};
+
+Loop loops[lemlib::monitor::MAX_LOOPS];
+std::atomic<int> loopCount {0};
+pros::Mutex loopMutex;
+pros::Mutex statsMutex;
+std::atomic<bool> started {false};
+
+/**
+ * @brief Get the least free stack the current task has ever had
+ *
+ * Only the current task is measured, so the task is always alive. Tasks like opcontrol are deleted without
+ * warning, and measuring them from another task could read freed memory
+ *
+ * @return int free stack in words, -1 if it is unavailable
+ */
+int freeStack() {
+  if (uxTaskGetStackHighWaterMark == nullptr) return -1;
+  return uxTaskGetStackHighWaterMark(nullptr);
+}
+
+/**
+ * @brief Update the statistics of every loop
+ *
+ * @param elapsed time since the last update, in microseconds
+ */
+void update(std::uint32_t elapsed) {
+  int count = loopCount.load(std::memory_order_acquire);
+  for (int id = 0; id < count; id++) {
+    Loop& loop = loops[id];
+    // the counters only ever increase, so the statistics of the last second are the change since the last update
+    std::uint32_t iterations = loop.iterations.load(std::memory_order_relaxed);
+    std::uint32_t periodTotal = loop.periodTotal.load(std::memory_order_relaxed);
+    std::uint32_t busyTotal = loop.busyTotal.load(std::memory_order_relaxed);
+    std::uint32_t newIterations = iterations - loop.prevIterations;
+    float meanPeriod = (newIterations > 0) ? (periodTotal - loop.prevPeriodTotal) / 1000.0 / newIterations : 0;
+    float maxPeriod = loop.maxPeriod.exchange(0, std::memory_order_relaxed) / 1000.0;
+    float cpu = (elapsed > 0) ? float(busyTotal - loop.prevBusyTotal) / elapsed : 0;
+    int stack = loop.freeStack.load(std::memory_order_relaxed);
+    loop.prevIterations = iterations;
+    loop.prevPeriodTotal = periodTotal;
+    loop.prevBusyTotal = busyTotal;
+
+    statsMutex.take();
+    loop.meanPeriod = meanPeriod;
+    loop.maxPeriodMs = maxPeriod;
+    loop.cpu = cpu;
+    loop.stack = stack;
+    statsMutex.give();
+  }
+}
+
+/**
+ * @brief Show the statistics of every loop on the brain screen
+ *
+ * @param firstLine first line of the screen to use
+ */
+void show(int firstLine) {
+  if (!pros::lcd::is_initialized()) return;
+  int count = loopCount.load(std::memory_order_acquire);
+  for (int id = 0; id < count && firstLine + id < 8; id++) {
+    lemlib::monitor::LoopStats_t stats = lemlib::monitor::getStats(id);
+    char line[64];
+    if (stats.freeStack >= 0) {
+      snprintf(line, sizeof(line), "%-9s %4.1f/%4.1fms %3.0f%% stack %d", stats.name, stats.meanPeriod,
+               stats.maxPeriod, stats.cpu * 100, stats.freeStack);
+    } else {
+      snprintf(line, sizeof(line), "%-9s %4.1f/%4.1fms %3.0f%% stack n/a", stats.name, stats.meanPeriod,
+               stats.maxPeriod, stats.cpu * 100);
+    }
+    pros::lcd::set_text(firstLine + id, line);
+  }
+}
+}  // namespace
+
+/**
+ * @brief Add a loop to monitor
+ *
+ * @param name name of the loop. Must be a string literal
+ * @param period target period of the loop, in milliseconds
+ * @return int id of the loop, -1 if there is no room for it
+ */
+int lemlib::monitor::addLoop(const char* name, int period) {
+  loopMutex.take();
+  int id = loopCount.load(std::memory_order_relaxed);
+  if (id < MAX_LOOPS) {
+    loops[id].name = name;
+    loops[id].period = period;
+    loopCount.store(id + 1, std::memory_order_release);
+  } else {
+    id = -1;
+  }
+  loopMutex.give();
+  if (id == -1) return -1;
+
+  telemetry::addChannel(name, 1, 4, [id](float* values) {
+    LoopStats_t stats = getStats(id);
+    values[0] = stats.meanPeriod;
+    values[1] = stats.maxPeriod;
+    values[2] = stats.cpu;
+    values[3] = stats.freeStack;
+  });
+  return id;
+}
+
+/**
+ * @brief Mark the start of an iteration of a loop
+ *
+ * @param id id of the loop
+ */
+void lemlib::monitor::beginLoop(int id) {
+  if (id < 0 || id >= MAX_LOOPS) return;
+  Loop& loop = loops[id];
+  std::uint32_t now = pros::micros();
+  pros::task_t task = pros::c::task_get_current();
+  if (loop.started && task == loop.task) {
+    std::uint32_t period = now - loop.start;
+    int bin = period / 1000;
+    if (bin >= HISTOGRAM_BINS) bin = HISTOGRAM_BINS - 1;
+    loop.histogram[bin].fetch_add(1, std::memory_order_relaxed);
+    loop.periodTotal.fetch_add(period, std::memory_order_relaxed);
+    loop.iterations.fetch_add(1, std::memory_order_relaxed);
+    // only this task raises the maximum, so a load and a store are enough
+    if (period > loop.maxPeriod.load(std::memory_order_relaxed)) {
+      loop.maxPeriod.store(period, std::memory_order_relaxed);
+    }
+    // measuring the stack scans it, so it is only done about once a second
+    if (loop.iterations.load(std::memory_order_relaxed) % (1000 / std::max(loop.period, 1)) == 0) {
+      loop.freeStack.store(freeStack(), std::memory_order_relaxed);
+    }
+  } else {
+    // first iteration, or the loop runs in a new task (opcontrol is restarted every time the robot is enabled).
+    // There is no previous iteration to measure the period from
+    loop.task = task;
+    loop.started = true;
+    loop.freeStack.store(freeStack(), std::memory_order_relaxed);
+  }
+  loop.start = now;
+}
+
+/**
+ * @brief Mark the end of the work of an iteration of a loop
+ *
+ * @param id id of the loop
+ */
+void lemlib::monitor::endLoop(int id) {
+  if (id < 0 || id >= MAX_LOOPS || !loops[id].started) return;
+  loops[id].busyTotal.fetch_add(static_cast<std::uint32_t>(pros::micros()) - loops[id].start,
+                                std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the statistics of a loop
+ *
+ * @param id id of the loop
+ * @return LoopStats_t the statistics
+ */
+lemlib::monitor::LoopStats_t lemlib::monitor::getStats(int id) {
+  LoopStats_t stats = {};
+  if (id < 0 || id >= loopCount.load(std::memory_order_acquire)) return stats;
+  Loop& loop = loops[id];
+  stats.name = loop.name;
+  stats.period = loop.period;
+  statsMutex.take();
+  stats.meanPeriod = loop.meanPeriod;
+  stats.maxPeriod = loop.maxPeriodMs;
+  stats.cpu = loop.cpu;
+  stats.freeStack = loop.stack;
+  statsMutex.give();
+  for (int bin = 0; bin < HISTOGRAM_BINS; bin++) stats.histogram[bin] = loop.histogram[bin].load();
+  return stats;
+}
+
+/**
+ * @brief Start the monitor task, which updates the statistics every second
+ *
+ * @param screen whether to show the statistics on the brain screen
+ * @param firstLine first line of the brain screen to use
+ */
+void lemlib::monitor::start(bool screen, int firstLine) {
+  if (started.exchange(true)) return;  // already started
+  pros::Task task(
+      [screen, firstLine] {
+        std::uint32_t prevTime = pros::micros();
+        while (true) {
+          pros::delay(1000);
+          std::uint32_t now = pros::micros();
+          update(now - prevTime);
+          prevTime = now;
+          if (screen) show(firstLine);
+        }
+      },
+      TASK_PRIORITY_MIN, TASK_STACK_DEPTH_DEFAULT, "LemLib monitor");
+}
+
+/**
+ * @brief Print the period histogram of every loop to the terminal
+ */
+void lemlib::monitor::print() {
+  int count = loopCount.load(std::memory_order_acquire);
+  for (int id = 0; id < count; id++) {
+    LoopStats_t stats = getStats(id);
+    printf("%s (target %d ms, mean %.2f ms, max %.2f ms, cpu %.1f%%, free stack ", stats.name, stats.period,
+           stats.meanPeriod, stats.maxPeriod, stats.cpu * 100);
+    if (stats.freeStack >= 0) {
+      printf("%d words)\n", stats.freeStack);
+    } else {
+      printf("unavailable)\n");
+    }
+    for (int bin = 0; bin < HISTOGRAM_BINS; bin++) {
+      if (stats.histogram[bin] == 0) continue;
+      printf("  %2d%s ms: %lu\n", bin, (bin == HISTOGRAM_BINS - 1) ? "+" : " ", (unsigned long)stats.histogram[bin]);
+    }
+  }
+}
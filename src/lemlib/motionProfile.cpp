@@ -0,0 +1,161 @@
+/**
+ * @file src/lemlib/motionProfile.cpp
+ * @author LemLib Team
+ * @brief Trapezoidal and S-curve motion profile definitions
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/motionProfile.hpp"
+
+#include <math.h>
+
+/**
+ * @brief Construct a new Motion Profile
+ *
+ * @param distance the distance to travel. Can be negative
+ * @param maxVelocity the maximum velocity
+ * @param maxAcceleration the maximum acceleration and deceleration
+ * @param maxJerk the maximum jerk. Trapezoidal profile if set to 0
+ */
+lemlib::MotionProfile::MotionProfile(float distance, float maxVelocity, float maxAcceleration, float maxJerk) {
+  this->direction = (distance < 0) ? -1 : 1;
+  this->distance = std::fabs(distance);
+  this->jerk = maxJerk;
+  float vel = std::fabs(maxVelocity);
+  float accel = std::fabs(maxAcceleration);
+
+  // the acceleration can't reach its peak if the velocity is too low
+  if (jerk != 0 && vel < accel * accel / jerk) accel = std::sqrt(vel * jerk);
+
+  // lower the cruise velocity if the distance is too short to reach it
+  // distance needed to accelerate and decelerate: vel * (vel / accel + accel / jerk)
+  float jerkTerm = (jerk != 0) ? accel / jerk : 0;
+  if (vel * (vel / accel + jerkTerm) > this->distance) {
+    vel = accel / 2 * (-jerkTerm + std::sqrt(jerkTerm * jerkTerm + 4 * this->distance / accel));
+    // peak acceleration is not reached either
+    if (jerk != 0 && vel < accel * accel / jerk) {
+      vel = std::pow(this->distance * std::sqrt(jerk) / 2, 2.0 / 3);
+      accel = std::sqrt(vel * jerk);
+    }
+  }
+
+  this->velocity = vel;
+  this->acceleration = accel;
+  this->jerkTime = (jerk != 0) ? accel / jerk : 0;
+  this->accelTime = (accel != 0) ? vel / accel - jerkTime : 0;
+  this->rampTime = accelTime + 2 * jerkTime;
+  float rampDistance = vel * rampTime / 2;  // the velocity curve is symmetric during the ramp
+  this->cruiseTime = (vel != 0) ? (this->distance - 2 * rampDistance) / vel : 0;
+  if (cruiseTime < 0) cruiseTime = 0;
+}
+
+/**
+ * @brief Get the duration of the profile
+ *
+ * @return float duration in seconds
+ */
+float lemlib::MotionProfile::getDuration() { return 2 * rampTime + cruiseTime; }
+
+/**
+ * @brief Get the position along the profile
+ *
+ * @param time time since the start of the profile, in seconds
+ * @return float position
+ */
+float lemlib::MotionProfile::getPosition(float time) {
+  float position, velocity, acceleration;
+  sample(time, position, velocity, acceleration);
+  return position;
+}
+
+/**
+ * @brief Get the velocity along the profile
+ *
+ * @param time time since the start of the profile, in seconds
+ * @return float velocity
+ */
+float lemlib::MotionProfile::getVelocity(float time) {
+  float position, velocity, acceleration;
+  sample(time, position, velocity, acceleration);
+  return velocity;
+}
+
+/**
+ * @brief Get the acceleration along the profile
+ *
+ * @param time time since the start of the profile, in seconds
+ * @return float acceleration
+ */
+float lemlib::MotionProfile::getAcceleration(float time) {
+  float position, velocity, acceleration;
+  sample(time, position, velocity, acceleration);
+  return acceleration;
+}
+
+/**
+ * @brief Sample the acceleration phase of the profile
+ *
+ * @param time time since the start of the acceleration phase
+ * @param position output position
+ * @param velocity output velocity
+ * @param acceleration output acceleration
+ */
+void lemlib::MotionProfile::sampleAccel(float time, float& position, float& velocity, float& acceleration) {
+  // acceleration ramps up
+  float t = std::fmin(time, jerkTime);
+  acceleration = jerk * t;
+  velocity = jerk * t * t / 2;
+  position = jerk * t * t * t / 6;
+  if (time <= jerkTime) return;
+
+  // constant acceleration
+  t = std::fmin(time - jerkTime, accelTime);
+  position += velocity * t + this->acceleration * t * t / 2;
+  velocity += this->acceleration * t;
+  acceleration = this->acceleration;
+  if (time <= jerkTime + accelTime) return;
+
+  // acceleration ramps down
+  t = std::fmin(time - jerkTime - accelTime, jerkTime);
+  position += velocity * t + this->acceleration * t * t / 2 - jerk * t * t * t / 6;
+  velocity += this->acceleration * t - jerk * t * t / 2;
+  acceleration = this->acceleration - jerk * t;
+}
+
+/**
+ * @brief Sample the profile
+ *
+ * @param time time since the start of the profile, in seconds
+ * @param position output position
+ * @param velocity output velocity
+ * @param acceleration output acceleration
+ */
+void lemlib::MotionProfile::sample(float time, float& position, float& velocity, float& acceleration) {
+  float duration = getDuration();
+  if (time <= 0) {
+    position = 0;
+    velocity = 0;
+    acceleration = 0;
+  } else if (time >= duration) {
+    position = distance;
+    velocity = 0;
+    acceleration = 0;
+  } else if (time < rampTime) {  // accelerating
+    sampleAccel(time, position, velocity, acceleration);
+  } else if (time < rampTime + cruiseTime) {  // cruising
+    position = this->velocity * rampTime / 2 + this->velocity * (time - rampTime);
+    velocity = this->velocity;
+    acceleration = 0;
+  } else {  // decelerating, the acceleration phase mirrored in time
+    sampleAccel(duration - time, position, velocity, acceleration);
+    position = distance - position;
+    acceleration = -acceleration;
+  }
+  position *= direction;
+  velocity *= direction;
+  acceleration *= direction;
+}
@@ -9,13 +9,16 @@
  *
  */
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <math.h>
 #include "lemlib/pid.hpp"
+#include "lemlib/profiler.hpp"
 #include "lemlib/util.hpp"
 
 // define static variables
-std::string lemlib::FAPID::input = "FAPID";
+lemlib::GainMailbox lemlib::FAPID::mailboxes[MAX_MAILBOXES];
 pros::Task* lemlib::FAPID::logTask = nullptr;
 pros::Mutex lemlib::FAPID::logMutex = pros::Mutex();
 
@@ -36,6 +39,19 @@ lemlib::FAPID::FAPID(float kF, float kA, float kP, float kI, float kD, std::stri
     this->kI = kI;
     this->kD = kD;
     this->name = name;
+    // share the mailbox of every FAPID with this name, so gains tuned in one motion carry over to the next
+    logMutex.take();
+    mailbox = findMailbox(name, true);
+    if (mailbox != nullptr) {
+        // until something is posted, show the gains of this FAPID
+        mailbox->show(GainMailbox::KF, kF);
+        mailbox->show(GainMailbox::KA, kA);
+        mailbox->show(GainMailbox::KP, kP);
+        mailbox->show(GainMailbox::KI, kI);
+        mailbox->show(GainMailbox::KD, kD);
+        seenResets = mailbox->resets.load(); // only resets posted from now on apply to this FAPID
+    }
+    logMutex.give();
 }
 
 /**
@@ -73,26 +89,101 @@ void lemlib::FAPID::setExit(float largeError, float smallError, int largeTime, i
 }
 
 /**
- * @brief Update the FAPID
+ * @brief Set the stopped exit condition
+ *
+ * @param settleError range where the error is considered settled. Set 0 to disable
+ * @param settleVelocity range where the velocity is considered stopped, in units of the error per second
+ * @param settleTime time in milliseconds the robot has to stay stopped
+ */
+void lemlib::FAPID::setSettle(float settleError, float settleVelocity, int settleTime) {
+    this->settleError = settleError;
+    this->settleVelocity = settleVelocity;
+    this->settleTime = settleTime;
+}
+
+/**
+ * @brief Set the derivative mode
+ *
+ * @param onMeasurement whether to take the derivative of the measurement instead of the error
+ * @param filterTime time constant of the low-pass filter on the derivative, in seconds. 0 to disable
+ */
+void lemlib::FAPID::setDerivative(bool onMeasurement, float filterTime) {
+    this->derivativeOnMeasurement = onMeasurement;
+    this->derivativeFilterTime = filterTime;
+}
+
+/**
+ * @brief Set the integral anti-windup
+ *
+ * @param integralLimit the maximum output of the integral term. 0 to disable
+ * @param resetOnSignChange whether to reset the integral when the error changes sign
+ */
+void lemlib::FAPID::setIntegral(float integralLimit, bool resetOnSignChange) {
+    this->integralLimit = integralLimit;
+    this->integralResetOnSignChange = resetOnSignChange;
+}
+
+/**
+ * @brief Update the FAPID, measuring the time since the last update
  *
  * @param target the target value
  * @param position the current value
- * @param log whether to check the most recent terminal input for user input. Default is false because logging multiple
- * PIDs could slow down the program.
+ * @param log whether to check for gains posted from the terminal. Default is false
  * @return float - output
  */
 float lemlib::FAPID::update(float target, float position, bool log) {
-    // check most recent input if logging is enabled
-    // this does not run by default because the mutexes could slow down the program
-    if (log) { lemlib::FAPID::log(); }
-    // calculate output
+    // the first update has no previous update to measure from, so it uses the nominal loop period
+    uint64_t now = pros::c::micros();
+    float dt = (prevMicros != 0) ? (now - prevMicros) / 1000000.0 : NOMINAL_DT;
+    prevMicros = now;
+    return updateDt(target, position, dt, log);
+}
+
+/**
+ * @brief Update the FAPID with a known time since the last update
+ *
+ * @param target the target value
+ * @param position the current value
+ * @param dt time since the last update, in seconds
+ * @param log whether to check for gains posted from the terminal. Default is false
+ * @return float - output
+ */
+float lemlib::FAPID::updateDt(float target, float position, float dt, bool log) {
+    lemlib::profiler::Scope scope("FAPID update");
+    // pick up gains posted from the terminal. This only uses atomics, so it never blocks the control loop
+    if (log && mailbox != nullptr) receive();
+    if (dt <= 0) dt = NOMINAL_DT;
+    // gains are tuned per nominal loop period, so scale the time dependent terms to the actual period
+    const float ticks = dt / NOMINAL_DT;
     float error = target - position;
-    float deltaError = error - prevError;
-    float output = kF * target + kP * error + kI * totalError + kD * deltaError;
-    if (kA != 0) output = lemlib::slew(output, prevOutput, kA);
+
+    // integral, with anti-windup
+    if (integralResetOnSignChange && lemlib::sgn(error) != lemlib::sgn(prevError)) totalError = 0;
+    totalError += error * ticks;
+    if (integralLimit != 0 && kI != 0) {
+        float maxTotal = std::fabs(integralLimit / kI);
+        totalError = std::fmax(-maxTotal, std::fmin(maxTotal, totalError));
+    }
+    if (log && mailbox != nullptr) mailbox->totalError.store(totalError, std::memory_order_relaxed);
+
+    // derivative, in change per nominal loop period. The first update has no previous value, so it has no derivative
+    float derivative = 0;
+    if (updated) {
+        derivative = (derivativeOnMeasurement) ? -(position - prevPosition) / ticks : (error - prevError) / ticks;
+    }
+    if (derivativeFilterTime > 0) {
+        derivative = prevDerivative + (derivative - prevDerivative) * dt / (derivativeFilterTime + dt);
+    }
+    errorRate = (updated) ? (error - prevError) / dt : 0; // used by the stopped exit condition
+
+    // calculate output
+    float output = kF * target + kP * error + kI * totalError + kD * derivative;
+    if (kA != 0) output = lemlib::slew(output, prevOutput, kA * ticks);
     prevOutput = output;
     prevError = error;
-    totalError += error;
+    prevPosition = position;
+    prevDerivative = derivative;
+    updated = true;
     return output;
 }
 
@@ -103,6 +194,11 @@ void lemlib::FAPID::reset() {
     prevError = 0;
     totalError = 0;
     prevOutput = 0;
+    errorRate = 0;
+    prevPosition = 0;
+    prevDerivative = 0;
+    prevMicros = 0;
+    updated = false;
 }
 
 /**
@@ -110,49 +206,89 @@ void lemlib::FAPID::reset() {
  *
  * If the exit conditions have not been set, this function will always return false
  *
+ * @param velocity the measured velocity, in units of the error per second
  * @return true - the FAPID has settled
  * @return false - the FAPID has not settled
  */
-bool lemlib::FAPID::settled() {
+bool lemlib::FAPID::settled(float velocity) {
+    if (exit != Exit::NONE) return true; // the FAPID has already settled
     if (startTime == 0) { // if maxTime has not been set
         startTime = pros::c::millis();
         return false;
     } else { // check if the FAPID has settled
-        if (pros::c::millis() - startTime > maxTime) return true; // maxTime has been exceeded
-        if (std::fabs(prevError) < largeError) { // largeError within range
+        // start measuring the time spent settling once the error first comes within range
+        if (!settleStartTime && std::fabs(prevError) < std::fmax(largeError, settleError))
+            settleStartTime = pros::c::millis();
+        if (pros::c::millis() - startTime > maxTime) exit = Exit::TIMEOUT; // maxTime has been exceeded
+        else if (std::fabs(prevError) < largeError) { // largeError within range
             if (!largeTimeCounter) largeTimeCounter = pros::c::millis(); // largeTimeCounter has not been set
-            else if (pros::c::millis() - largeTimeCounter > largeTime) return true; // largeTime has been exceeded
+            else if (pros::c::millis() - largeTimeCounter > largeTime) exit = Exit::LARGE_ERROR; // largeTime exceeded
         }
-        if (std::fabs(prevError) < smallError) { // smallError within range
+        if (exit == Exit::NONE && std::fabs(prevError) < smallError) { // smallError within range
             if (!smallTimeCounter) smallTimeCounter = pros::c::millis(); // smallTimeCounter has not been set
-            else if (pros::c::millis() - smallTimeCounter > smallTime) return true; // smallTime has been exceeded
+            else if (pros::c::millis() - smallTimeCounter > smallTime) exit = Exit::SMALL_ERROR; // smallTime exceeded
         }
-        // if none of the exit conditions have been met
-        return false;
+        // the robot has stopped close to the target
+        if (exit == Exit::NONE && std::fabs(prevError) < settleError && std::fabs(errorRate) < settleVelocity &&
+            std::fabs(velocity) < settleVelocity) {
+            if (!settleTimeCounter) settleTimeCounter = pros::c::millis(); // settleTimeCounter has not been set
+            if (pros::c::millis() - settleTimeCounter >= settleTime) exit = Exit::STOPPED; // settleTime reached
+        } else {
+            settleTimeCounter = 0; // the robot has to stay stopped for the whole settle time
+        }
+        if (exit == Exit::NONE) return false; // if none of the exit conditions have been met
+        exitTime = pros::c::millis();
+        return true;
     }
 }
 
+/**
+ * @brief Get the exit condition that settled the FAPID
+ *
+ * @return Exit - the exit condition, NONE if the FAPID has not settled
+ */
+lemlib::FAPID::Exit lemlib::FAPID::getExit() { return exit; }
+
+/**
+ * @brief Get the time spent settling
+ *
+ * @return int - time in milliseconds, 0 if the error never came within range
+ */
+int lemlib::FAPID::getSettleTime() {
+    if (!settleStartTime) return 0;
+    return ((exitTime) ? exitTime : pros::c::millis()) - settleStartTime;
+}
+
+/**
+ * @brief Check if the FAPID uses gains posted from the terminal
+ *
+ * @return true - the FAPID uses posted gains
+ * @return false - the FAPID uses the gains set in code
+ */
+bool lemlib::FAPID::hasPostedGains() { return seenSequence != 0; }
+
 /**
  * @brief Enable logging
- * the user can interact with the FAPID through the terminal
- * the user can access gains and other variables with the following format:
+ * a task reads std::cin so the user can interact with the FAPID through the terminal
+ * the user can access gains with the following format:
  * <name>.<variable> to get the value of the variable
  * <name>.<variable>_<value> to set the value of the variable
- * for example:z
+ * for example:
  * pid.kP_0.5 will set the kP value to 0.5
- * list of variables thats value can be set:
+ * list of variables thats value can be set and accessed:
  * kF, kA, kP, kI, kD
  * list of variables that can be accessed:
- * kF, kA, kP, kI, kD, totalError
+ * totalError, as of the last update of a FAPID with that name and log set to true
  * list of functions that can be called:
  * reset()
  */
 void lemlib::FAPID::init() {
-    if (logTask != nullptr) {
+    if (logTask == nullptr) {
         logTask = new pros::Task {[=] {
+            std::string input;
             while (true) {
                 // get input
-                std::cin >> input;
+                if (std::cin >> input) command(input);
                 pros::delay(20);
             }
         }};
@@ -160,50 +296,76 @@ void lemlib::FAPID::init() {
 }
 
 /**
- * @brief Log the FAPID
- */
-void lemlib::FAPID::log() {
-    // check if the input starts with the name of the FAPID
-    // try to obtain the logging mutex
-    if (logMutex.take(5)) {
-        if (input.find(name) == 0) {
-            // remove the name from the input
-            input.erase(0, name.length() + 1);
-            // check if the input is a function
-            if (input == "reset()") {
-                reset();
-            } else if (input == "kF") {
-                std::cout << kF << std::endl;
-            } else if (input == "kA") {
-                std::cout << kA << std::endl;
-            } else if (input == "kP") {
-                std::cout << kP << std::endl;
-            } else if (input == "kI") {
-                std::cout << kI << std::endl;
-            } else if (input == "kD") {
-                std::cout << kD << std::endl;
-            } else if (input == "totalError") {
-                std::cout << totalError << std::endl;
-            } else if (input.find("kF_") == 0) {
-                input.erase(0, 3);
-                kF = std::stof(input);
-            } else if (input.find("kA_") == 0) {
-                input.erase(0, 3);
-                kA = std::stof(input);
-            } else if (input.find("kP_") == 0) {
-                input.erase(0, 3);
-                kP = std::stof(input);
-            } else if (input.find("kI_") == 0) {
-                input.erase(0, 3);
-                kI = std::stof(input);
-            } else if (input.find("kD_") == 0) {
-                input.erase(0, 3);
-                kD = std::stof(input);
+ * @brief Pick up gains and resets posted to the mailbox
+ */
+void lemlib::FAPID::receive() {
+    // if the logging task is writing the gains, they are picked up on the next update
+    float gains[GainMailbox::GAINS];
+    if (mailbox->receive(seenSequence, gains)) {
+        setGains(gains[GainMailbox::KF], gains[GainMailbox::KA], gains[GainMailbox::KP], gains[GainMailbox::KI],
+                 gains[GainMailbox::KD]);
+    }
+    uint32_t resets = mailbox->resets.load(std::memory_order_relaxed);
+    if (resets != seenResets) {
+        reset();
+        seenResets = resets;
+    }
+}
+
+/**
+ * @brief Find the mailbox of a name. The logging mutex must be held
+ *
+ * @param name name of the FAPID
+ * @param create whether to create the mailbox if it does not exist
+ * @return GainMailbox* - the mailbox, nullptr if it does not exist or there is no room for it
+ */
+lemlib::GainMailbox* lemlib::FAPID::findMailbox(const std::string& name, bool create) {
+    for (GainMailbox& mailbox : mailboxes) {
+        if (mailbox.name[0] == '\0') { // the rest of the mailboxes are unused
+            if (!create || name.empty() || name.length() >= sizeof(mailbox.name)) return nullptr;
+            std::strcpy(mailbox.name, name.c_str());
+            return &mailbox;
+        }
+        if (name == mailbox.name) return &mailbox;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Run a command from the terminal
+ *
+ * @param input the command, in the format <name>.<variable>, <name>.<variable>_<value> or <name>.reset()
+ */
+void lemlib::FAPID::command(const std::string& input) {
+    size_t dot = input.find('.');
+    if (dot == std::string::npos) return;
+    std::string command = input.substr(dot + 1);
+    logMutex.take();
+    GainMailbox* mailbox = findMailbox(input.substr(0, dot), false);
+    if (mailbox != nullptr) {
+        if (command == "reset()") {
+            mailbox->resets++;
+        } else if (command == "totalError") {
+            std::cout << mailbox->totalError.load() << std::endl;
+        } else {
+            // find the gain
+            size_t underscore = command.find('_');
+            std::string variable = command.substr(0, underscore);
+            int gain = -1;
+            if (variable == "kF") gain = GainMailbox::KF;
+            else if (variable == "kA") gain = GainMailbox::KA;
+            else if (variable == "kP") gain = GainMailbox::KP;
+            else if (variable == "kI") gain = GainMailbox::KI;
+            else if (variable == "kD") gain = GainMailbox::KD;
+            if (gain != -1 && underscore == std::string::npos) { // get the value of the gain
+                std::cout << mailbox->get(GainMailbox::Gain(gain)) << std::endl;
+            } else if (gain != -1) { // set the value of the gain
+                const char* value = command.c_str() + underscore + 1;
+                char* end;
+                float newGain = std::strtof(value, &end);
+                if (end != value && *end == '\0') mailbox->post(GainMailbox::Gain(gain), newGain);
             }
-            // clear the input
-            input = "";
         }
-        // release the logging mutex
-        logMutex.give();
     }
+    logMutex.give();
 }
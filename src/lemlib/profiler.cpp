@@ -0,0 +1,175 @@
+/**
+ * @file src/lemlib/profiler.cpp
+ * @author LemLib Team
+ * @brief Scoped trace events, saved to the SD card and viewed as a Chrome trace
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/profiler.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#include "lemlib/taskTable.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+/**
+ * @brief An event in RAM. Names are pointers until the trace is saved
+ */
+struct Event {
+  std::uint32_t time;
+  const char* name;
+  std::uint8_t task;  // index in the task table
+  char phase;
+};
+
+// tasks that have recorded events. Every run of a task (like opcontrol) is shown as the same thread
+constexpr int MAX_TASKS = 32;
+
+Event events[lemlib::profiler::MAX_EVENTS];
+lemlib::TaskTable<MAX_TASKS> tasks;
+std::atomic<std::uint32_t> head {0};  // total number of events recorded, the next one goes at head % MAX_EVENTS
+std::atomic<bool> recording {false};
+std::atomic<int> writers {0};  // number of events being written right now
+pros::Mutex dumpMutex;
+
+/**
+ * @brief Find the current task in the task table, adding it if it is not there
+ *
+ * @return std::uint8_t index of the task
+ */
+std::uint8_t currentTask() { return tasks.find(pros::c::task_get_name(nullptr)); }
+
+/**
+ * @brief Record an event
+ *
+ * @param name name of the section
+ * @param phase 'B' for the start of a section, 'E' for the end
+ */
+void record(const char* name, char phase) {
+  if (!recording.load(std::memory_order_relaxed)) return;
+  // announce the write before checking again, so dump() either sees this writer or this writer sees the pause
+  writers.fetch_add(1);
+  if (recording.load()) {
+    // claim a slot with one atomic add, so tasks never wait on each other
+    std::uint32_t index = head.fetch_add(1, std::memory_order_relaxed) % lemlib::profiler::MAX_EVENTS;
+    events[index] = {static_cast<std::uint32_t>(pros::micros()), name, currentTask(), phase};
+  }
+  writers.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Find a pointer in a table, adding it if it is not there
+ *
+ * @param table the table
+ * @param count number of entries in the table
+ * @param max size of the table
+ * @param pointer the pointer to find
+ * @return int index of the pointer, or max - 1 if the table is full
+ */
+template <typename T> int intern(T* table, int& count, int max, T pointer) {
+  for (int i = 0; i < count; i++) {
+    if (table[i] == pointer) return i;
+  }
+  if (count == max) return max - 1;
+  table[count] = pointer;
+  return count++;
+}
+
+/**
+ * @brief Write a name to a trace file, as a length byte then the characters
+ *
+ * @param file the file
+ * @param name the name
+ */
+void writeName(FILE* file, const char* name) {
+  std::size_t length = std::strlen(name);
+  if (length > 255) length = 255;
+  std::uint8_t lengthByte = length;
+  fwrite(&lengthByte, 1, 1, file);
+  fwrite(name, 1, length, file);
+}
+}  // namespace
+
+/**
+ * @brief Start recording trace events
+ */
+void lemlib::profiler::start() { recording = true; }
+
+/**
+ * @brief Stop recording trace events
+ */
+void lemlib::profiler::stop() { recording = false; }
+
+/**
+ * @brief Record the start of a section
+ *
+ * @param name name of the section
+ */
+void lemlib::profiler::begin(const char* name) { record(name, 'B'); }
+
+/**
+ * @brief Record the end of a section
+ *
+ * @param name name of the section
+ */
+void lemlib::profiler::end(const char* name) { record(name, 'E'); }
+
+/**
+ * @brief Save the recorded events to the SD card
+ *
+ * @param path path of the file. No need to preface it with /usd/
+ * @return true the trace was saved
+ * @return false the file could not be created
+ */
+bool lemlib::profiler::dump(const char* path) {
+  dumpMutex.take();
+  // pause recording and wait for events that are being written, so the events don't change while they are saved
+  bool wasRecording = recording.exchange(false);
+  while (writers.load(std::memory_order_acquire) != 0) pros::delay(1);
+
+  char fullPath[64];
+  snprintf(fullPath, sizeof(fullPath), "/usd/%s", path);
+  FILE* file = fopen(fullPath, "wb");
+  if (file == nullptr) {
+    recording = wasRecording;
+    dumpMutex.give();
+    return false;
+  }
+
+  // oldest event first
+  std::uint32_t total = head.load(std::memory_order_relaxed);
+  std::uint32_t count = (total < MAX_EVENTS) ? total : MAX_EVENTS;
+  std::uint32_t oldest = total - count;
+
+  // replace the pointers with indices into a table of names, which is written once at the start of the file
+  static const char* names[255];
+  int nameCount = 0, taskCount = 0;
+  for (std::uint32_t i = oldest; i < total; i++) {
+    Event& event = events[i % MAX_EVENTS];
+    intern(names, nameCount, 255, event.name);
+    if (event.task >= taskCount) taskCount = event.task + 1;
+  }
+  TraceHeader_t header = {{'L', 'L', 'T', 'R'}, static_cast<std::uint16_t>(nameCount),
+                          static_cast<std::uint16_t>(taskCount), count};
+  fwrite(&header, sizeof(header), 1, file);
+  for (int i = 0; i < nameCount; i++) writeName(file, names[i]);
+  for (int i = 0; i < taskCount; i++) writeName(file, tasks.getName(i));
+  for (std::uint32_t i = oldest; i < total; i++) {
+    Event& event = events[i % MAX_EVENTS];
+    TraceRecord_t record = {event.time, event.phase,
+                            static_cast<std::uint8_t>(intern(names, nameCount, 255, event.name)), event.task};
+    fwrite(&record, sizeof(record), 1, file);
+  }
+  fclose(file);
+
+  recording = wasRecording;
+  dumpMutex.give();
+  return true;
+}
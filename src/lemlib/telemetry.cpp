@@ -0,0 +1,119 @@
+/**
+ * @file src/lemlib/telemetry.cpp
+ * @author LemLib Team
+ * @brief Binary telemetry over the serial terminal
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lemlib/telemetry.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "lemlib/blackbox.hpp"
+#include "pros/apix.h"
+#include "pros/rtos.hpp"
+
+namespace {
+std::atomic<bool> enabled {false};
+std::atomic<std::uint32_t> records {0};
+std::atomic<std::uint32_t> bytes {0};
+std::atomic<std::uint32_t> micros {0};
+}  // namespace
+
+/**
+ * @brief Start sending telemetry
+ */
+void lemlib::telemetry::init() {
+  // raw bytes, and never wait on the serial port from a control loop
+  pros::c::serctl(SERCTL_DISABLE_COBS, nullptr);
+  pros::c::fdctl(STDOUT_FILENO, SERCTL_NOBLKWRITE, nullptr);
+  enabled = true;
+}
+
+/**
+ * @brief Send the position of the robot
+ *
+ * @param pose the position, with theta in degrees
+ */
+void lemlib::telemetry::pose(const Pose& pose) {
+  PoseRecord record = {pose.x, pose.y, pose.theta};
+  send(RecordType::POSE, &record, sizeof(record));
+}
+
+/**
+ * @brief Send the voltage, velocity and current of a motor
+ *
+ * @param motor the motor
+ */
+void lemlib::telemetry::motor(pros::Motor& motor) {
+  MotorRecord record = {motor.get_port(), static_cast<std::int16_t>(motor.get_voltage()),
+                        static_cast<std::int16_t>(motor.get_actual_velocity() * 10),
+                        static_cast<std::int16_t>(motor.get_current_draw())};
+  send(RecordType::MOTOR, &record, sizeof(record));
+}
+
+/**
+ * @brief Send the voltage, velocity and current of every motor in a group
+ *
+ * @param motors the motor group
+ */
+void lemlib::telemetry::motors(pros::Motor_Group& motors) {
+  // index the motors directly so no vectors are allocated
+  int count = motors.size();
+  for (int i = 0; i < count; i++) motor(motors[i]);
+}
+
+/**
+ * @brief Send the error and output of a controller
+ *
+ * @param id id of the controller, chosen by the user
+ * @param error the error of the controller
+ * @param output the output of the controller
+ */
+void lemlib::telemetry::controller(std::uint8_t id, float error, float output) {
+  ControllerRecord record = {id, error, output};
+  send(RecordType::CONTROLLER, &record, sizeof(record));
+}
+
+/**
+ * @brief Send a record
+ *
+ * @param type the type of the record
+ * @param payload the record
+ * @param length size of the record in bytes
+ */
+void lemlib::telemetry::send(RecordType type, const void* payload, std::uint8_t length) {
+  bool serial = enabled.load(std::memory_order_relaxed);
+  if (!serial && !lemlib::blackbox::isEnabled()) return;
+  std::uint64_t start = pros::micros();
+  // build the whole frame first, so it is written in one call and frames from different tasks don't interleave
+  std::uint8_t frame[sizeof(FrameHeader) + 255 + 1];
+  FrameHeader header = {{SYNC_1, SYNC_2}, static_cast<std::uint8_t>(type), length, pros::millis()};
+  std::memcpy(frame, &header, sizeof(header));
+  std::memcpy(frame + sizeof(header), payload, length);
+  std::size_t size = sizeof(header) + length;
+  frame[size] = crc8(frame + 2, size - 2);
+  size++;
+  if (serial) fwrite(frame, 1, size, stdout);
+  lemlib::blackbox::record(frame, size);
+
+  records.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(size, std::memory_order_relaxed);
+  micros.fetch_add(pros::micros() - start, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the cost of the telemetry sent so far
+ *
+ * @return TelemetryStats_t bytes sent and time spent sending
+ */
+lemlib::telemetry::TelemetryStats_t lemlib::telemetry::getStats() {
+  return {records.load(), bytes.load(), micros.load()};
+}
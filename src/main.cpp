@@ -40,6 +40,11 @@ lemlib::Drivetrain_t drivetrain{
     10,
     3.25,
     360,
+    0,   // max velocity (in/s), 0 uses the theoretical max
+    80,  // max acceleration (in/s^2), for the path profiles, and the motion profiles if they are enabled
+    60,  // max deceleration (in/s^2)
+    60,  // max lateral acceleration (in/s^2)
+    0,   // max jerk (in/s^3), 0 uses trapezoidal profiles
 };
 
 // lateral motion controller
@@ -50,7 +55,10 @@ lemlib::ChassisController_t lateralController{
     100,
     3,
     500,
-    20};
+    20,
+    1,
+    2,
+    50};
 
 // angular motion controller
 lemlib::ChassisController_t angularController{
@@ -60,7 +68,10 @@ lemlib::ChassisController_t angularController{
     100,
     3,
     500,
-    3};
+    3,
+    1,
+    10,
+    50};
 
 // sensors for odometry
 lemlib::OdomSensors_t sensors{
@@ -70,7 +81,27 @@ lemlib::OdomSensors_t sensors{
     nullptr,
     &imu};
 
-lemlib::Chassis chassis(drivetrain, lateralController, angularController, sensors);
+// path following
+lemlib::FollowSettings_t followSettings{
+    5,       // min lookahead (in)
+    16,      // max lookahead (in)
+    0.15,    // lookahead time (s)
+    10,      // curvature gain
+    0.0013,  // RAMSETE b (1/in^2)
+    0.7};    // RAMSETE zeta
+
+// wheel velocity control. Measure kS, kV and kA with chassis.characterize()
+// velocity control is disabled while kV is 0
+lemlib::VelocityController_t velocityController{
+    0,   // kS
+    0,   // kV
+    0,   // kA
+    0};  // kP
+
+lemlib::Chassis chassis(drivetrain, lateralController, angularController, sensors, followSettings, velocityController);
+
+// monitored opcontrol loop, added in initialize()
+int opcontrolLoop = -1;
 
 /**
  * Runs initialization code. This occurs as soon as the program is started.
@@ -101,7 +132,26 @@ void initialize() {
 
   // Initialize chassis and auton selector
   chassis.calibrate();
+  // motion profiles stay off until the velocity constants are measured: with the voltage output and no constants,
+  // profiled motions are slower than unprofiled ones
+  chassis.setMotionProfiles(false);
   auton_selector.initialize();
+
+  // Telemetry channels, kept by the black box. Call lemlib::telemetry::init() to also stream them over serial
+  chassis.addTelemetry();
+  lemlib::telemetry::addChannel("intake.velocity", 10,
+                                [] { return float(pros::c::motor_get_actual_velocity(INTAKE)); });
+  lemlib::telemetry::addChannel("cata.current", 20, [] { return float(pros::c::motor_get_current_draw(CATA)); });
+  lemlib::telemetry::addChannel("cata.temperature", 1, [] { return float(pros::c::motor_get_temperature(CATA)); });
+  lemlib::blackbox::init();
+  lemlib::telemetry::startChannels();
+  lemlib::profiler::start();
+  opcontrolLoop = lemlib::monitor::addLoop("opcontrol", 10);
+  lemlib::monitor::start(true);
+
+  // everything after this point should run without allocating. Allocations are printed when the robot is disabled
+  lemlib::heap::finishInitialize();
+  lemlib::heap::setGuard(true);
 }
 
 /**
@@ -110,7 +160,9 @@ void initialize() {
  * the robot is enabled, this task will exit.
  */
 void disabled() {
-  // . . .
+  // save the trace of the mode that just ended. Convert it with tools/traceConvert.cpp
+  lemlib::profiler::dump("trace.bin");
+  lemlib::heap::print();
 }
 
 /**
@@ -148,7 +200,6 @@ void autonomous() {
 
 void arcade_standard2(bool reverse) {
   bool is_tank = false;
-  chassis.reset_drive_sensor();
 
   int fwd_stick, turn_stick;
   // Put the joysticks through the curve function
@@ -205,6 +256,8 @@ void opcontrol() {
   unsigned int delayWings = 0;
   unsigned int delayFlip = 0;
   while (true) {
+    lemlib::profiler::begin("opcontrol");
+    lemlib::monitor::beginLoop(opcontrolLoop);
     // drive
     arcade_standard2(flipDrive);  // Standard split arcade ++
 
@@ -254,6 +307,9 @@ void opcontrol() {
       delayFlip--;
     }
 
+    // both end before the delay, so they only measure the work of the loop
+    lemlib::monitor::endLoop(opcontrolLoop);
+    lemlib::profiler::end("opcontrol");
     pros::delay(10);  // This is used for timer calculations!
                       // Keep this ez::util::DELAY_TIME
   }
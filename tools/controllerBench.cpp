@@ -0,0 +1,162 @@
+/**
+ * @file tools/controllerBench.cpp
+ * @author LemLib Team
+ * @brief Host benchmark counting the instructions of a controller update
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Counts the instructions the real lemlib::FAPID and lemlib::Controller run per update, with the same gains. The
+// count is exact: a child process runs the updates while this process single steps it with ptrace, so it works
+// without hardware performance counters. The parts of PROS pid.cpp links against are stubbed by prosStubs.cpp.
+// The counts are for the host CPU. The V5 brain has a different instruction set, so compare the ratios, not the counts.
+// Build on Linux with:
+//   g++ -std=c++17 -O2 -pthread -I../include controllerBench.cpp prosStubs.cpp ../src/lemlib/pid.cpp
+//       ../src/lemlib/util.cpp -o controllerBench
+// Usage: controllerBench
+
+#include <signal.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <type_traits>
+
+#include "lemlib/controller.hpp"
+#include "lemlib/pid.hpp"
+#include "lemlib/profiler.hpp"
+#include "lemlib/util.hpp"
+
+namespace {
+/**
+ * @brief Updates in each counted section. The count is divided by this
+ */
+constexpr int UPDATES = 100;
+
+typedef lemlib::Controller<lemlib::ProportionalTerm, lemlib::DerivativeTerm<>> PD;
+typedef lemlib::Controller<lemlib::FeedforwardTerm, lemlib::ProportionalTerm, lemlib::IntegralTerm<>,
+                           lemlib::DerivativeTerm<>, lemlib::SlewLimit>
+    FullController;
+
+// the controllers are globals, so the child process that runs the counted section gets them in the state the warm
+// up left them in. The FAPIDs are created in main(), after the statics of pid.cpp they use
+lemlib::FAPID* fapidPD;
+lemlib::FAPID* fapidFull;
+PD controllerPD({10}, {30});
+FullController controllerFull({1}, {10}, {0.1}, {30}, {20});
+
+// the inputs are volatile, so the updates can't be folded into constants
+volatile float target = 24;
+volatile float position = 0;
+volatile float sink = 0;
+
+// each update goes through a function that is never inlined, so every controller pays for the same call
+
+__attribute__((noinline)) float update(lemlib::FAPID& pid, float target, float position) {
+  return pid.updateDt(target, position, 0.01f);
+}
+
+template <class C> __attribute__((noinline)) float update(C& controller, float target, float position) {
+  return controller.update(target, position, 0.01f);
+}
+
+/**
+ * @brief Run UPDATES updates of a controller, driving the position toward the target
+ *
+ * @tparam C the type of the controller
+ * @param controller the controller
+ */
+template <class C> void run(C& controller) {
+  for (int i = 0; i < UPDATES; i++) {
+    sink = update(controller, target, position);
+    position = position + 0.1f;
+  }
+}
+
+void nothing() {}
+void runFapidPD() { run(*fapidPD); }
+void runFapidFull() { run(*fapidFull); }
+void runControllerPD() { run(controllerPD); }
+void runControllerFull() { run(controllerFull); }
+
+/**
+ * @brief Count the instructions a function runs, including those of the stops around it
+ *
+ * @param section the function
+ * @return long the number of instructions, -1 if the child could not be traced
+ */
+long countInstructions(void (*section)()) {
+  pid_t child = fork();
+  if (child == 0) {
+    ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+    raise(SIGSTOP);
+    section();
+    raise(SIGSTOP);
+    _exit(0);
+  }
+  int status;
+  waitpid(child, &status, 0);  // stopped before the section
+  long steps = 0;
+  while (true) {
+    if (ptrace(PTRACE_SINGLESTEP, child, nullptr, nullptr) != 0) {
+      steps = -1;
+      break;
+    }
+    waitpid(child, &status, 0);
+    if (!WIFSTOPPED(status) || WSTOPSIG(status) == SIGSTOP) break;  // stopped after the section
+    steps++;
+  }
+  kill(child, SIGKILL);
+  waitpid(child, &status, 0);
+  return steps;
+}
+
+/**
+ * @brief Print the instructions per update of a controller
+ *
+ * @param name name of the controller
+ * @param section function running the updates
+ * @param baseline instructions of an empty section
+ * @param size size of the controller, in bytes
+ * @param trivial whether the controller is trivially copyable
+ */
+void print(const char* name, void (*section)(), long baseline, int size, bool trivial) {
+  long count = countInstructions(section);
+  if (count < 0) {
+    std::printf("  %-36s could not be traced\n", name);
+    return;
+  }
+  std::printf("  %-36s %8.1f %8d bytes %18s\n", name, double(count - baseline) / UPDATES, size,
+              trivial ? "yes" : "no");
+}
+}  // namespace
+
+int main() {
+  fapidPD = new lemlib::FAPID(0, 0, 10, 0, 30, "benchPD");
+  fapidFull = new lemlib::FAPID(1, 20, 10, 0.1, 30, "benchFull");
+  // warm up, so the state of the controllers is steady and the calls into shared libraries are bound
+  runFapidPD();
+  runFapidFull();
+  runControllerPD();
+  runControllerFull();
+  position = 0;
+
+  long baseline = countInstructions(nothing);
+  if (baseline < 0) {
+    std::printf("ptrace is not allowed\n");
+    return 1;
+  }
+  std::printf("Instructions per update, over %d updates\n", UPDATES);
+  std::printf("  %-36s %8s %14s %18s\n", "controller", "instr", "size", "trivially copyable");
+  print("FAPID, PD", runFapidPD, baseline, sizeof(lemlib::FAPID), std::is_trivially_copyable_v<lemlib::FAPID>);
+  print("Controller, PD", runControllerPD, baseline, sizeof(PD), std::is_trivially_copyable_v<PD>);
+  print("FAPID, feedforward, PID and slew", runFapidFull, baseline, sizeof(lemlib::FAPID),
+        std::is_trivially_copyable_v<lemlib::FAPID>);
+  print("Controller, feedforward, PID and slew", runControllerFull, baseline, sizeof(FullController),
+        std::is_trivially_copyable_v<FullController>);
+  return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file tools/loggerCheck/main.cpp
+ * @author LemLib Team
+ * @brief Host check of the logger configuration and compile time log level across translation units
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Links two files that both log against the real configuration in src/lemlib/loggerConfig.cpp, and a log()
+// that counts messages instead of printing them. Checks that a setting changed in one file is seen by the other,
+// and that messages below LEMLIB_MIN_LOG_LEVEL never reach log() from either file.
+// Build on Linux with (every file must use the same LEMLIB_MIN_LOG_LEVEL):
+//   g++ -std=c++17 -O2 -I../../include -DLEMLIB_MIN_LOG_LEVEL=2 main.cpp other.cpp ../../src/lemlib/loggerConfig.cpp
+//       -o loggerCheck
+// Usage: loggerCheck. Returns 0 if every check passes
+
+#include <cstdio>
+
+#include "lemlib/logger.hpp"
+#include "other.hpp"
+
+using lemlib::logger::Level;
+
+int logged[5] = {};  // messages that reached log(), by level
+
+void lemlib::logger::log(Level level, const char* message, const char* exception) { logged[int(level)]++; }
+
+void lemlib::logger::log(Level level, const char* message) { logged[int(level)]++; }
+
+int failures = 0;
+
+/**
+ * @brief Print the result of a check
+ *
+ * @param passed whether the check passed
+ * @param description what was checked
+ */
+void check(bool passed, const char* description) {
+  std::printf("%s %s\n", passed ? "pass" : "FAIL", description);
+  if (!passed) failures++;
+}
+
+int main() {
+  check(other::minLevel() == int(lemlib::logger::MIN_LEVEL), "both files are compiled with the same minimum level");
+
+  // settings changed in one file are seen by the other
+  other::configure(true, true, Level::DEBUG);
+  check(lemlib::logger::isDebug() && lemlib::logger::isVerbose(), "debug and verbose set in other.cpp");
+  check(lemlib::logger::getLowestLevel() == Level::DEBUG, "lowest level set in other.cpp");
+  lemlib::logger::setDebug(false);
+  lemlib::logger::setVerbose(false);
+  lemlib::logger::setLowestLevel(Level::ERROR);
+  check(!other::debug() && !other::verbose(), "debug and verbose cleared in main.cpp");
+  check(other::lowestLevel() == Level::ERROR, "lowest level set in main.cpp");
+
+  // each file logs one message of every level. Levels below the minimum are removed at compile time, so log()
+  // only sees the others, twice
+  lemlib::logger::debug("debug");
+  lemlib::logger::info("info");
+  lemlib::logger::warn("warn");
+  lemlib::logger::error("error");
+  lemlib::logger::fatal("fatal");
+  other::logEveryLevel();
+  const char* const names[] = {"DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+  for (int level = 0; level < 5; level++) {
+    int expected = (level >= int(lemlib::logger::MIN_LEVEL)) ? 2 : 0;
+    char description[64];
+    std::snprintf(description, sizeof(description), "%s messages logged %d times (expected %d)", names[level],
+                  logged[level], expected);
+    check(logged[level] == expected, description);
+  }
+
+  std::printf("%s, minimum level %d\n", failures == 0 ? "all checks passed" : "some checks failed",
+              int(lemlib::logger::MIN_LEVEL));
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file tools/loggerCheck/other.cpp
+ * @author LemLib Team
+ * @brief The second file of the logger check
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "other.hpp"
+
+int other::minLevel() { return int(lemlib::logger::MIN_LEVEL); }
+
+void other::configure(bool debug, bool verbose, lemlib::logger::Level lowestLevel) {
+  lemlib::logger::setDebug(debug);
+  lemlib::logger::setVerbose(verbose);
+  lemlib::logger::setLowestLevel(lowestLevel);
+}
+
+bool other::debug() { return lemlib::logger::isDebug(); }
+
+bool other::verbose() { return lemlib::logger::isVerbose(); }
+
+lemlib::logger::Level other::lowestLevel() { return lemlib::logger::getLowestLevel(); }
+
+void other::logEveryLevel() {
+  lemlib::logger::debug("debug");
+  lemlib::logger::info("info");
+  lemlib::logger::warn("warn");
+  lemlib::logger::error("error");
+  lemlib::logger::fatal("fatal");
+}
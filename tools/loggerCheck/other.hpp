@@ -0,0 +1,58 @@
+/**
+ * @file tools/loggerCheck/other.hpp
+ * @author LemLib Team
+ * @brief The second file of the logger check
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include "lemlib/logger.hpp"
+
+namespace other {
+/**
+ * @brief Get the minimum level other.cpp was compiled with
+ *
+ * @return int ordinal of the level
+ */
+int minLevel();
+
+/**
+ * @brief Change the logger configuration from other.cpp
+ *
+ * @param debug new value of lemlib::debug
+ * @param verbose new value of lemlib::verbose
+ * @param lowestLevel new lowest level
+ */
+void configure(bool debug, bool verbose, lemlib::logger::Level lowestLevel);
+
+/**
+ * @brief Read lemlib::debug from other.cpp
+ *
+ * @return bool the value
+ */
+bool debug();
+
+/**
+ * @brief Read lemlib::verbose from other.cpp
+ *
+ * @return bool the value
+ */
+bool verbose();
+
+/**
+ * @brief Read the lowest level from other.cpp
+ *
+ * @return lemlib::logger::Level the level
+ */
+lemlib::logger::Level lowestLevel();
+
+/**
+ * @brief Log one message of every level from other.cpp
+ */
+void logEveryLevel();
+}  // namespace other
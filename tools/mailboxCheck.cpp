@@ -0,0 +1,96 @@
+/**
+ * @file tools/mailboxCheck.cpp
+ * @author LemLib Team
+ * @brief Host check that readers of a gain mailbox never see half written gains
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// One thread posts gains to a lemlib::GainMailbox as fast as it can, like the logging task does, while other
+// threads read them like FAPIDs do. Post n sets gain n % 5 to n, so the gains after any number of posts are known,
+// and every read is checked against the gains at the sequence number it returned.
+// Build on Linux with: g++ -std=c++17 -O2 -pthread -I../include mailboxCheck.cpp -o mailboxCheck
+// Usage: mailboxCheck [posts] [readers]. Returns 0 if every read was consistent
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "lemlib/gainMailbox.hpp"
+
+using lemlib::GainMailbox;
+
+/**
+ * @brief Get the value of a gain after a number of posts
+ *
+ * @param gain index of the gain
+ * @param posts number of posts
+ * @return float the value
+ */
+float expected(int gain, std::uint32_t posts) {
+  if (posts <= std::uint32_t(gain)) return 0;  // not posted yet
+  std::uint32_t last = posts - 1;  // the last post
+  return float(last - (last - gain) % GainMailbox::GAINS);
+}
+
+int main(int argc, char** argv) {
+  // the values are exact in a float up to 2^24
+  std::uint32_t posts = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  int readerCount = (argc > 2) ? std::atoi(argv[2]) : 3;
+  if (posts > (1u << 24) || readerCount < 1) {
+    std::fprintf(stderr, "usage: %s [posts, at most 16777216] [readers, at least 1]\n", argv[0]);
+    return 1;
+  }
+
+  GainMailbox mailbox;
+  std::atomic<bool> done {false};
+  std::vector<std::thread> readers;
+  std::vector<unsigned long> reads(readerCount, 0), errors(readerCount, 0);
+  for (int id = 0; id < readerCount; id++) {
+    readers.emplace_back([&, id] {
+      std::uint32_t seen = 0;
+      float gains[GainMailbox::GAINS];
+      bool last = false;
+      // after the writer is done, read once more so the final gains are always checked
+      while (!last) {
+        last = done.load();
+        bool received = mailbox.receive(seen, gains);
+        std::this_thread::yield();  // let the writer run, even on a single core
+        if (!received) continue;
+        reads[id]++;
+        for (int gain = 0; gain < GainMailbox::GAINS; gain++) {
+          if (gains[gain] != expected(gain, seen / 2)) {
+            if (errors[id]++ < 5) {
+              std::printf("reader %d: gain %d is %.0f after %u posts, expected %.0f\n", id, gain, gains[gain],
+                          seen / 2, expected(gain, seen / 2));
+            }
+          }
+        }
+      }
+      if (seen != posts * 2) {
+        std::printf("reader %d: last read after %u posts, expected %u\n", id, seen / 2, posts);
+        errors[id]++;
+      }
+    });
+  }
+
+  for (std::uint32_t n = 0; n < posts; n++) {
+    mailbox.post(GainMailbox::Gain(n % GainMailbox::GAINS), float(n));
+    if (n % 64 == 0) std::this_thread::yield();  // let the readers run
+  }
+  done = true;
+  for (std::thread& reader : readers) reader.join();
+
+  unsigned long totalReads = 0, totalErrors = 0;
+  for (int id = 0; id < readerCount; id++) {
+    totalReads += reads[id];
+    totalErrors += errors[id];
+  }
+  std::printf("%u posts, %d readers, %lu reads, %lu inconsistent\n", posts, readerCount, totalReads, totalErrors);
+  return totalErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file tools/pidCommandCheck.cpp
+ * @author LemLib Team
+ * @brief Host check of the FAPID terminal commands
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Runs the real FAPID logging task on the host, with its stdin and stdout replaced by pipes. Command lines are
+// written to the pipe the task reads, like the user typing them in the terminal, and their effect is checked through
+// FAPID::update() with log set to true, and through what the task prints. Covers getting and setting gains, posted
+// gains carrying over to new FAPIDs with the same name, totalError, reset(), and commands that must be ignored. The
+// parts of PROS pid.cpp links against are stubbed by prosStubs.cpp.
+// Build on Linux with:
+//   g++ -std=c++17 -O2 -pthread -I../include pidCommandCheck.cpp prosStubs.cpp ../src/lemlib/pid.cpp
+//       ../src/lemlib/util.cpp -o pidCommandCheck
+// Usage: pidCommandCheck. Returns 0 if every check passed
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+#include "lemlib/pid.hpp"
+
+namespace {
+/**
+ * @brief How long the logging task gets to run a command, in milliseconds
+ */
+constexpr int TIMEOUT = 2000;
+
+FILE* report;  // the real stdout, since stdout is read by the checks
+int commandPipe;  // write end of the pipe the logging task reads as stdin
+int outputPipe;  // read end of the pipe the logging task prints to as stdout
+int failures = 0;
+
+/**
+ * @brief Print the result of a check
+ *
+ * @param passed whether the check passed
+ * @param description what was checked
+ */
+void check(bool passed, const std::string& description) {
+  std::fprintf(report, "  %-4s %s\n", passed ? "ok" : "FAIL", description.c_str());
+  if (!passed) failures++;
+}
+
+/**
+ * @brief Type a command in the terminal
+ *
+ * @param command the command, without the newline
+ */
+void type(const std::string& command) {
+  std::string line = command + "\n";
+  if (write(commandPipe, line.data(), line.size()) != ssize_t(line.size())) std::perror("write");
+}
+
+/**
+ * @brief Read a line the logging task printed
+ *
+ * @return std::string the line, without the newline. Empty if nothing was printed before the timeout
+ */
+std::string readLine() {
+  std::string line;
+  pollfd fd = {outputPipe, POLLIN, 0};
+  char c;
+  while (poll(&fd, 1, TIMEOUT) > 0 && read(outputPipe, &c, 1) == 1) {
+    if (c == '\n') return line;
+    line += c;
+  }
+  return "";
+}
+
+/**
+ * @brief Update a FAPID with log set to true until its output meets a condition
+ *
+ * The logging task runs the command asynchronously, so the FAPID picks it up on some later update
+ *
+ * @param pid the FAPID
+ * @param condition the condition on the output
+ * @return float the last output
+ */
+float updateUntil(lemlib::FAPID& pid, const std::function<bool(float)>& condition) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TIMEOUT);
+  float output;
+  do {
+    output = pid.update(1, 0, true);  // an error of 1, so the output is kP plus kI times the total error
+    if (condition(output)) break;
+    usleep(1000);
+  } while (std::chrono::steady_clock::now() < deadline);
+  return output;
+}
+}  // namespace
+
+int main() {
+  // keep the real stdout for the report, then put the pipes in place before the logging task starts
+  int commandFds[2];
+  int outputFds[2];
+  if (pipe(commandFds) != 0 || pipe(outputFds) != 0) {
+    std::perror("pipe");
+    return 1;
+  }
+  report = fdopen(dup(STDOUT_FILENO), "w");
+  setvbuf(report, nullptr, _IONBF, 0);
+  dup2(commandFds[0], STDIN_FILENO);
+  dup2(outputFds[1], STDOUT_FILENO);
+  commandPipe = commandFds[1];
+  outputPipe = outputFds[0];
+
+  // the FAPIDs are created in main(), after the statics of pid.cpp they use
+  lemlib::FAPID pid(0, 0, 10, 0, 0, "check");
+  lemlib::FAPID::init();
+  std::fprintf(report, "FAPID terminal commands\n");
+
+  check(pid.update(1, 0, true) == 10 && !pid.hasPostedGains(), "the gains set in code are used until gains are posted");
+  type("check.kP");
+  check(readLine() == "10", "check.kP prints the gain set in code");
+
+  type("check.kP_2.5");
+  check(updateUntil(pid, [](float output) { return output == 2.5f; }) == 2.5f && pid.hasPostedGains(),
+        "check.kP_2.5 sets kP on the next update with log set to true");
+  type("check.kP");
+  check(readLine() == "2.5", "check.kP prints the posted gain");
+  lemlib::FAPID later(0, 0, 10, 0, 0, "check");
+  check(later.update(1, 0, true) == 2.5f, "a FAPID created later with the same name uses the posted gain");
+  lemlib::FAPID silent(0, 0, 10, 0, 0, "check");
+  check(silent.update(1, 0) == 10 && !silent.hasPostedGains(), "updates with log set to false ignore posted gains");
+
+  // malformed and unknown commands change nothing and print nothing. The last command prints, and commands run in
+  // order, so the next line read is its output
+  for (const char* command : {"check.kP_", "check.kP_abc", "check.kP_7x", "check.kQ_1", "check.kQ", "other.kP_1",
+                              "other.kP", "nodot", "check.", "check.reset"}) {
+    type(command);
+  }
+  type("check.kD");
+  check(readLine() == "0", "malformed commands and unknown names or gains print nothing");
+  type("check.kP");
+  check(readLine() == "2.5", "malformed commands leave the gains alone");
+
+  // totalError is the total error of the last update with log set to true
+  type("check.kI_1");
+  updateUntil(pid, [](float output) { return output != 2.5f; });
+  pid.reset();
+  for (int i = 0; i < 3; i++) pid.update(1, 0, true);
+  type("check.totalError");
+  check(readLine() == "3", "check.totalError prints the total error of the last logged update");
+
+  // before the reset is picked up the total error keeps growing, so an output of kP plus kI is the first update
+  // after the reset
+  type("check.reset()");
+  check(updateUntil(pid, [](float output) { return output == 3.5f; }) == 3.5f,
+        "check.reset() resets the FAPID on the next update with log set to true");
+  lemlib::FAPID afterReset(0, 0, 10, 0, 0, "check");
+  afterReset.update(1, 0, true);
+  check(afterReset.update(1, 0, true) == 4.5f, "a reset posted before a FAPID was created does not reset it");
+
+  close(commandPipe);
+  std::fprintf(report, "%d failed\n", failures);
+  return failures == 0 ? 0 : 1;
+}
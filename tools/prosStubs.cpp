@@ -0,0 +1,79 @@
+/**
+ * @file tools/prosStubs.cpp
+ * @author LemLib Team
+ * @brief Host stand-ins for the parts of PROS the PROS-free LemLib sources link against
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Lets the host tools link the real src/lemlib/pid.cpp, src/lemlib/util.cpp and the control laws in
+// src/lemlib/chassis. Tasks run on threads and mutexes are real mutexes, so the FAPID logging task works on the
+// host. The clock is set by the tool, see stubs::setTime(). The screen functions do nothing, and the profiler
+// returns immediately, like the real one before profiler::start().
+// Tools that link this file need -pthread
+
+#include "prosStubs.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "lemlib/profiler.hpp"
+#include "pros/llemu.hpp"
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+std::atomic<uint64_t> now = 0;  // in microseconds
+}  // namespace
+
+/**
+ * @brief Set the time returned by pros::millis() and pros::micros()
+ *
+ * @param seconds time since the program started, in seconds
+ */
+void stubs::setTime(double seconds) { now = seconds * 1000000; }
+
+extern "C" {
+uint32_t millis(void) { return now / 1000; }
+
+uint64_t micros(void) { return now; }
+
+void delay(const uint32_t milliseconds) { std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds)); }
+}
+
+pros::Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth,
+                 const char* name) {
+  std::thread(function, parameters).detach();
+}
+
+pros::Mutex::Mutex()
+    : mutex(static_cast<void*>(new std::mutex), [](void* mutex) { delete static_cast<std::mutex*>(mutex); }) {}
+
+bool pros::Mutex::take() {
+  static_cast<std::mutex*>(mutex.get())->lock();
+  return true;
+}
+
+bool pros::Mutex::give() {
+  static_cast<std::mutex*>(mutex.get())->unlock();
+  return true;
+}
+
+pros::Controller::Controller(pros::controller_id_e_t id)
+    : _id(id) {}
+
+bool pros::lcd::set_text(std::int16_t line, std::string text) { return true; }
+
+bool pros::lcd::clear() { return true; }
+
+bool pros::lcd::clear_line(std::int16_t line) { return true; }
+
+void lemlib::profiler::begin(const char* name) {}
+
+void lemlib::profiler::end(const char* name) {}
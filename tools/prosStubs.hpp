@@ -0,0 +1,23 @@
+/**
+ * @file tools/prosStubs.hpp
+ * @author LemLib Team
+ * @brief Host stand-ins for the parts of PROS the PROS-free LemLib sources link against
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+namespace stubs {
+/**
+ * @brief Set the time returned by pros::millis() and pros::micros()
+ *
+ * The clock only moves when it is set, so simulations can run FAPIDs on simulated time
+ *
+ * @param seconds time since the program started, in seconds
+ */
+void setTime(double seconds);
+}  // namespace stubs
@@ -0,0 +1,178 @@
+/**
+ * @file tools/sim/followerSim.cpp
+ * @author LemLib Team
+ * @brief Host simulation comparing path followers
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Runs the loops of Chassis::follow() and Chassis::ramsete() on a simulated drivetrain, over a path with a tight
+// corner and an S curve, and prints how long each follower took and how far it strayed from the path. Compares fixed
+// and adaptive lookahead, velocity control against scaling velocities to power, then pure pursuit against RAMSETE.
+// The followers are the real lemlib::PurePursuit and lemlib::Ramsete, on paths profiled with the real
+// lemlib::profilePath() and lemlib::timeParameterize(). Only the loops around them, which read the odometry and drive
+// the motors, are replaced by the simulation. The wheel velocity constants are measured on the simulated robot with
+// the tests of Chassis::characterize() and the real lemlib::FeedforwardFit.
+// Build on Linux with:
+//   g++ -std=c++17 -O2 -pthread -I../../include followerSim.cpp sim.cpp ../prosStubs.cpp
+//       ../../src/lemlib/chassis/pathFollower.cpp ../../src/lemlib/chassis/motionControl.cpp
+//       ../../src/lemlib/chassis/feedforwardFit.cpp ../../src/lemlib/chassis/pathProfile.cpp
+//       ../../src/lemlib/motionProfile.cpp ../../src/lemlib/pid.cpp ../../src/lemlib/gainSchedule.cpp
+//       ../../src/lemlib/util.cpp ../../src/lemlib/pose.cpp -o followerSim
+// Usage: followerSim
+
+#include <cstdio>
+
+#include "lemlib/chassis/pathFollower.hpp"
+#include "lemlib/chassis/pathProfile.hpp"
+#include "sim.hpp"
+
+namespace {
+/**
+ * @brief The follow settings of the robot in src/main.cpp
+ */
+constexpr lemlib::FollowSettings_t FOLLOW_SETTINGS = {5, 16, 0.15, 10, 0.0013, 0.7};
+
+/**
+ * @brief How far the robot drives during each test of the characterization, in inches. Two field tiles
+ */
+constexpr float CHARACTERIZE_DISTANCE = 48;
+
+/**
+ * @brief The small error of the lateral controller of the robot in src/main.cpp, which ends Chassis::ramsete()
+ */
+constexpr float LATERAL_SMALL_ERROR = 1;
+
+/**
+ * @brief Follow a path with pure pursuit, like Chassis::follow()
+ *
+ * @param path the path
+ * @param conditions the conditions to simulate
+ * @param lookahead the lookahead distance in inches, 0 for the adaptive lookahead
+ * @param velocitySettings the wheel velocity constants. Velocity control is disabled if kV is 0
+ * @return sim::FollowStats_t how well the path was followed
+ */
+sim::FollowStats_t pursuit(sim::Path path, sim::Conditions_t conditions, float lookahead,
+                           lemlib::VelocityController_t velocitySettings) {
+  sim::Drivetrain robot(conditions);
+  sim::FollowRecorder recorder(path);
+  const int timeout = 10000;
+  lemlib::profilePath(path, sim::DRIVETRAIN);
+  lemlib::PurePursuit follower(path, sim::DRIVETRAIN, FOLLOW_SETTINGS, velocitySettings, lookahead, false, 127);
+
+  for (int i = 0; i < timeout / 10; i++) {
+    if (!follower.update(robot.pose, sim::DT, robot.leftVelocity, robot.rightVelocity)) break;
+    robot.move(follower.getLeftPower(), follower.getRightPower());
+    robot.step();
+    recorder.record(robot);
+  }
+  return recorder.finish(robot);
+}
+
+/**
+ * @brief Follow a path with RAMSETE, like Chassis::ramsete()
+ *
+ * @param path the path
+ * @param conditions the conditions to simulate
+ * @param velocitySettings the wheel velocity constants. Velocity control is disabled if kV is 0
+ * @return sim::FollowStats_t how well the path was followed
+ */
+sim::FollowStats_t ramsete(sim::Path path, sim::Conditions_t conditions,
+                           lemlib::VelocityController_t velocitySettings) {
+  sim::Drivetrain robot(conditions);
+  sim::FollowRecorder recorder(path);
+  const int timeout = 10000;
+  lemlib::profilePath(path, sim::DRIVETRAIN);
+  lemlib::Ramsete follower(lemlib::timeParameterize(path), sim::DRIVETRAIN, FOLLOW_SETTINGS, velocitySettings, false,
+                           127, LATERAL_SMALL_ERROR);
+
+  while (robot.time * 1000 < timeout) {
+    if (!follower.update(robot.pose, robot.time, robot.leftVelocity, robot.rightVelocity)) break;
+    robot.move(follower.getLeftPower(), follower.getRightPower());
+    robot.step();
+    recorder.record(robot);
+  }
+  return recorder.finish(robot);
+}
+
+/**
+ * @brief Print the statistics of a follower
+ *
+ * @param name name of the follower
+ * @param stats the statistics
+ */
+void print(const char* name, sim::FollowStats_t stats) {
+  std::printf("  %-26s %6.2f s %7.2f in %7.2f in %7.2f in %7.1f deg\n", name, stats.time, stats.meanError,
+              stats.maxError, stats.endError, stats.endHeadingError);
+}
+
+/**
+ * @brief Print the header of a table of followers
+ *
+ * @param title title of the table
+ * @param pathName name of the path
+ */
+void printHeader(const char* title, const char* pathName) {
+  std::printf("%s, %s path\n", title, pathName);
+  std::printf("  %-26s %8s %10s %10s %10s %11s\n", "follower", "time", "mean error", "max error", "end error",
+              "end heading");
+}
+}  // namespace
+
+int main() {
+  const struct {
+    const char* name;
+    sim::Path path;
+  } paths[] = {{"corner", sim::cornerPath()}, {"S curve", sim::sCurvePath()}};
+
+  // fixed lookahead distances against the adaptive lookahead, from the min lookahead of the follow settings to past
+  // the longest lookahead the adaptive lookahead reaches
+  for (const auto& path : paths) {
+    printHeader("Pure pursuit lookahead", path.name);
+    for (sim::Conditions_t conditions : {sim::NOMINAL, sim::LOADED}) {
+      char name[32];
+      for (float lookahead : {5.0f, 8.0f, 12.0f, 16.0f}) {
+        std::snprintf(name, sizeof(name), "%s, fixed %.0f in", conditions.name, lookahead);
+        print(name, pursuit(path.path, conditions, lookahead, sim::NO_VELOCITY_CONTROLLER));
+      }
+      std::snprintf(name, sizeof(name), "%s, adaptive", conditions.name);
+      print(name, pursuit(path.path, conditions, 0, sim::NO_VELOCITY_CONTROLLER));
+    }
+    std::printf("\n");
+  }
+
+  // velocity control against scaling the velocities to power, with a charged battery and an empty robot, and with
+  // a drained battery and a heavier robot. The velocity constants are measured in the first conditions, with the same
+  // tests as Chassis::characterize()
+  const lemlib::VelocityController_t measured = sim::characterize(sim::NOMINAL, CHARACTERIZE_DISTANCE);
+  std::printf("Measured velocity constants: kS = %.2f, kV = %.3f, kA = %.3f\n\n", measured.kS, measured.kV,
+              measured.kA);
+  for (const auto& path : paths) {
+    printHeader("Pure pursuit velocity control", path.name);
+    for (sim::Conditions_t conditions : {sim::NOMINAL, sim::LOADED}) {
+      char name[32];
+      std::snprintf(name, sizeof(name), "%s, power", conditions.name);
+      print(name, pursuit(path.path, conditions, 0, sim::NO_VELOCITY_CONTROLLER));
+      std::snprintf(name, sizeof(name), "%s, velocity control", conditions.name);
+      print(name, pursuit(path.path, conditions, 0, measured));
+    }
+    std::printf("\n");
+  }
+
+  // both followers on the same profiled paths, with velocity control
+  for (const auto& path : paths) {
+    printHeader("Pure pursuit against RAMSETE", path.name);
+    for (sim::Conditions_t conditions : {sim::NOMINAL, sim::LOADED}) {
+      char name[32];
+      std::snprintf(name, sizeof(name), "%s, pure pursuit", conditions.name);
+      print(name, pursuit(path.path, conditions, 0, measured));
+      std::snprintf(name, sizeof(name), "%s, RAMSETE", conditions.name);
+      print(name, ramsete(path.path, conditions, measured));
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,327 @@
+/**
+ * @file tools/sim/motionSim.cpp
+ * @author LemLib Team
+ * @brief Host simulation of point to point motions
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Runs the loop of Chassis::moveTo() on a simulated drivetrain, through a scripted autonomous of four legs, and
+// prints how long the autonomous took. Compares stopping at every waypoint, with and without motion profiles, against
+// chaining the legs with a minimum speed. Then compares the output modes on a single motion, in nominal conditions
+// and with a drained battery and a heavier robot. The control law is the real lemlib::MoveToController, with the
+// real FAPID and lemlib::MotionProfile, and the outputs go through the real lemlib::sideOutput(). Only the loop
+// around them, which reads the odometry and drives the motors, is replaced by the simulation. The simulation drives
+// the clock the FAPIDs read. The wheel velocity constants are measured on the simulated robot with the tests of
+// Chassis::characterize() and the real lemlib::FeedforwardFit.
+// Build on Linux with:
+//   g++ -std=c++17 -O2 -pthread -I../../include motionSim.cpp sim.cpp ../prosStubs.cpp
+//       ../../src/lemlib/chassis/motionControl.cpp ../../src/lemlib/chassis/feedforwardFit.cpp
+//       ../../src/lemlib/chassis/pathProfile.cpp ../../src/lemlib/motionProfile.cpp ../../src/lemlib/pid.cpp
+//       ../../src/lemlib/gainSchedule.cpp ../../src/lemlib/util.cpp ../../src/lemlib/pose.cpp -o motionSim
+// Usage: motionSim
+
+#include <math.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "lemlib/chassis/motionControl.hpp"
+#include "lemlib/chassis/pathProfile.hpp"
+#include "lemlib/util.hpp"
+#include "sim.hpp"
+
+namespace {
+/**
+ * @brief How far the robot drives during each test of the characterization, in inches. Two field tiles
+ */
+constexpr float CHARACTERIZE_DISTANCE = 48;
+
+/**
+ * @brief The lateral controller of the robot in src/main.cpp
+ */
+constexpr lemlib::ChassisController_t LATERAL_CONTROLLER = {10, 30, 1, 100, 3, 500, 20, 1, 2, 50, nullptr};
+
+/**
+ * @brief The angular controller of the robot in src/main.cpp
+ */
+constexpr lemlib::ChassisController_t ANGULAR_CONTROLLER = {2, 10, 1, 100, 3, 500, 3, 1, 10, 50, nullptr};
+
+/**
+ * @brief A waypoint of the scripted autonomous
+ *
+ * @param x x position of the waypoint, in inches
+ * @param y y position of the waypoint, in inches
+ */
+typedef struct {
+  float x;
+  float y;
+} Waypoint_t;
+
+/**
+ * @brief The scripted autonomous. Each leg turns 45 degrees from the one before it
+ */
+constexpr Waypoint_t AUTON[] = {{0, 24}, {24, 48}, {48, 48}, {72, 24}};
+
+/**
+ * @brief The motions of lemlib::Chassis, driving a simulated drivetrain
+ */
+class Chassis {
+ public:
+  /**
+   * @brief Construct a new Chassis
+   *
+   * @param conditions the conditions to simulate
+   * @param motionProfiles whether the motions follow motion profiles, like lemlib::Chassis::setMotionProfiles()
+   * @param outputMode how the outputs of the controllers drive the motors
+   * @param velocitySettings the wheel velocity constants. Those of src/main.cpp are 0
+   */
+  Chassis(sim::Conditions_t conditions, bool motionProfiles,
+          lemlib::OutputMode outputMode = lemlib::OutputMode::VOLTAGE,
+          lemlib::VelocityController_t velocitySettings = sim::NO_VELOCITY_CONTROLLER)
+      : robot(conditions),
+        drivetrain(sim::DRIVETRAIN),
+        motionProfiles(motionProfiles),
+        constants({sim::DRIVETRAIN, LATERAL_CONTROLLER, ANGULAR_CONTROLLER, velocitySettings, outputMode}),
+        battery(conditions.battery) {}
+
+  /**
+   * @brief Move the chassis towards the target point, like lemlib::Chassis::moveTo()
+   *
+   * @param x x location
+   * @param y y location
+   * @param timeout longest time the robot can spend moving
+   * @param maxSpeed the maximum speed the robot can move at
+   * @param minSpeed the minimum speed the robot drives at. If not 0, the motion is chained
+   * @param earlyExitRange how close to the target the chained motion exits, in inches
+   */
+  void moveTo(float x, float y, int timeout, float maxSpeed = 127, float minSpeed = 0, float earlyExitRange = 0) {
+    lemlib::MoveToController controller(constants, x, y, timeout, maxSpeed, minSpeed, earlyExitRange,
+                                        motionProfiles && drivetrain.maxAcceleration != 0, chainLateralPower,
+                                        chainAngularPower);
+    const float start = robot.time;
+    // a chained motion continues at the velocity of the previous motion
+    prevLeftVelocity = (chainLateralPower + chainAngularPower) * lemlib::maxVelocity(drivetrain) / 127;
+    prevRightVelocity = (chainLateralPower - chainAngularPower) * lemlib::maxVelocity(drivetrain) / 127;
+
+    while ((robot.time - start) * 1000 < timeout) {
+      if (!controller.update(getPose(), robot.time - start, battery, false)) break;
+      output(controller.getLeftPower(), controller.getRightPower());
+      step();
+    }
+
+    if (controller.isChained()) {
+      chainLateralPower = controller.getLateralPower();
+      chainAngularPower = controller.getAngularPower();
+    } else {
+      robot.move(0, 0);
+      chainLateralPower = 0;
+      chainAngularPower = 0;
+    }
+    settleTime = controller.getLateralPID().getSettleTime() / 1000.0;
+  }
+
+  /**
+   * @brief Advance the simulation by DT, keeping track of how far the robot drove
+   */
+  void step() {
+    robot.step();
+    furthest = std::max(furthest, robot.pose.y);
+  }
+
+  sim::Drivetrain robot;
+  float settleTime = 0;  // time the last motion spent settling, in seconds
+  float furthest = 0;  // furthest the robot has driven along the y axis, in inches
+ private:
+  /**
+   * @brief Get the pose of the robot, in degrees like lemlib::getPose()
+   *
+   * @return lemlib::Pose the pose
+   */
+  lemlib::Pose getPose() const {
+    return lemlib::Pose(robot.pose.x, robot.pose.y, lemlib::radToDeg(robot.pose.theta));
+  }
+
+  /**
+   * @brief Drive the drivetrain with the outputs of the controllers, like lemlib::Chassis::output()
+   *
+   * @param leftPower output for the left side, out of 127
+   * @param rightPower output for the right side, out of 127
+   */
+  void output(float leftPower, float rightPower) {
+    lemlib::SideOutput_t left = lemlib::sideOutput(constants, leftPower, prevLeftVelocity, robot.leftVelocity);
+    lemlib::SideOutput_t right = lemlib::sideOutput(constants, rightPower, prevRightVelocity, robot.rightVelocity);
+    if (left.velocity) {
+      robot.moveVelocity(left.value, right.value);
+    } else {
+      robot.move(left.value, right.value);
+    }
+  }
+
+  const lemlib::Drivetrain_t drivetrain;
+  const bool motionProfiles;
+  const lemlib::ChassisConstants_t constants;
+  const float battery;
+  float prevLeftVelocity = 0;
+  float prevRightVelocity = 0;
+  float chainLateralPower = 0;
+  float chainAngularPower = 0;
+};
+
+/**
+ * @brief Statistics of the scripted autonomous
+ *
+ * @param time time until the last motion exited, in seconds
+ * @param slowest slowest speed of the robot when a leg exited, except for the last, in inches per second
+ * @param endError distance from the last waypoint once the robot stopped, in inches
+ */
+typedef struct {
+  float time;
+  float slowest;
+  float endError;
+} AutonStats_t;
+
+/**
+ * @brief Run the scripted autonomous
+ *
+ * @param conditions the conditions to simulate
+ * @param motionProfiles whether the motions follow motion profiles
+ * @param minSpeed minimum speed of every leg but the last. 0 stops at every waypoint
+ * @param earlyExitRange how close to a waypoint a chained leg exits, in inches
+ * @return AutonStats_t the statistics
+ */
+AutonStats_t runAuton(sim::Conditions_t conditions, bool motionProfiles, float minSpeed, float earlyExitRange) {
+  Chassis chassis(conditions, motionProfiles);
+  const int legs = sizeof(AUTON) / sizeof(AUTON[0]);
+  AutonStats_t stats = {0, INFINITY, 0};
+  for (int leg = 0; leg < legs; leg++) {
+    bool last = leg == legs - 1;
+    chassis.moveTo(AUTON[leg].x, AUTON[leg].y, 4000, 127, last ? 0 : minSpeed, last ? 0 : earlyExitRange);
+    float speed = (chassis.robot.leftVelocity + chassis.robot.rightVelocity) / 2;
+    if (!last) stats.slowest = std::min(stats.slowest, std::fabs(speed));
+  }
+  stats.time = chassis.robot.time;
+  // let the robot coast to a stop
+  for (int i = 0; i < 300 && (chassis.robot.leftVelocity != 0 || chassis.robot.rightVelocity != 0); i++) {
+    chassis.step();
+  }
+  const Waypoint_t& end = AUTON[legs - 1];
+  stats.endError = std::hypot(chassis.robot.pose.x - end.x, chassis.robot.pose.y - end.y);
+  return stats;
+}
+
+/**
+ * @brief Statistics of a single motion
+ *
+ * @param time time until the motion exited, in seconds
+ * @param settleTime time spent settling, in seconds
+ * @param overshoot how far the robot drove past the target, including after the motion exited, in inches
+ * @param endError distance from the target once the robot stopped, in inches
+ */
+typedef struct {
+  float time;
+  float settleTime;
+  float overshoot;
+  float endError;
+} MoveStats_t;
+
+/**
+ * @brief Drive 48 inches forward from rest
+ *
+ * @param conditions the conditions to simulate
+ * @param motionProfiles whether the motion follows a motion profile
+ * @param outputMode how the outputs of the controllers drive the motors
+ * @param velocitySettings the wheel velocity constants
+ * @return MoveStats_t the statistics
+ */
+MoveStats_t runMove(sim::Conditions_t conditions, bool motionProfiles, lemlib::OutputMode outputMode,
+                    lemlib::VelocityController_t velocitySettings) {
+  const float distance = 48;
+  Chassis chassis(conditions, motionProfiles, outputMode, velocitySettings);
+  chassis.moveTo(0, distance, 4000);
+  MoveStats_t stats = {chassis.robot.time, chassis.settleTime, 0, 0};
+  // let the robot coast to a stop
+  for (int i = 0; i < 300 && (chassis.robot.leftVelocity != 0 || chassis.robot.rightVelocity != 0); i++) {
+    chassis.step();
+  }
+  stats.overshoot = std::max(0.0f, chassis.furthest - distance);
+  stats.endError = std::hypot(chassis.robot.pose.x, chassis.robot.pose.y - distance);
+  return stats;
+}
+
+/**
+ * @brief Print the statistics of an autonomous
+ *
+ * @param name name of the run
+ * @param stats the statistics
+ */
+void print(const char* name, AutonStats_t stats) {
+  std::printf("  %-40s %6.2f s %10.1f in/s %7.2f in\n", name, stats.time, stats.slowest, stats.endError);
+}
+
+/**
+ * @brief Print the statistics of a single motion
+ *
+ * @param name name of the run
+ * @param stats the statistics
+ */
+void print(const char* name, MoveStats_t stats) {
+  std::printf("  %-40s %6.2f s %9.2f s %7.2f in %7.2f in\n", name, stats.time, stats.settleTime, stats.overshoot,
+              stats.endError);
+}
+}  // namespace
+
+int main() {
+  // with motion profiles enabled, the motions that start and end at rest are profiled. The last leg of a chained
+  // autonomous starts moving, so it is not. src/main.cpp leaves the profiles disabled
+  const struct {
+    const char* name;
+    bool enabled;
+  } profiles[] = {{"unprofiled", false}, {"profiled", true}};
+
+  for (sim::Conditions_t conditions : {sim::NOMINAL, sim::LOADED}) {
+    std::printf("Scripted autonomous, %s\n", conditions.name);
+    std::printf("  %-40s %8s %15s %10s\n", "motions", "time", "slowest handoff", "end error");
+    for (const auto& profile : profiles) {
+      char name[64];
+      std::snprintf(name, sizeof(name), "%s, stop at each waypoint", profile.name);
+      print(name, runAuton(conditions, profile.enabled, 0, 0));
+      for (float minSpeed : {30.0f, 60.0f, 90.0f}) {
+        std::snprintf(name, sizeof(name), "%s, chained at min speed %.0f", profile.name, minSpeed);
+        print(name, runAuton(conditions, profile.enabled, minSpeed, 4));
+      }
+    }
+    std::printf("\n");
+  }
+
+  // the output modes on the same motion, and the voltage output with the velocity constants, which the feedforward of
+  // the profiles uses. The velocity constants are measured in nominal conditions, with the same tests as
+  // Chassis::characterize()
+  const lemlib::VelocityController_t measured = sim::characterize(sim::NOMINAL, CHARACTERIZE_DISTANCE);
+  std::printf("Measured velocity constants: kS = %.2f, kV = %.3f, kA = %.3f\n\n", measured.kS, measured.kV,
+              measured.kA);
+  const struct {
+    const char* name;
+    lemlib::OutputMode mode;
+    lemlib::VelocityController_t velocitySettings;
+  } modes[] = {{"voltage", lemlib::OutputMode::VOLTAGE, sim::NO_VELOCITY_CONTROLLER},
+               {"voltage, velocity constants", lemlib::OutputMode::VOLTAGE, measured},
+               {"motor velocity", lemlib::OutputMode::MOTOR_VELOCITY, sim::NO_VELOCITY_CONTROLLER},
+               {"wheel velocity", lemlib::OutputMode::WHEEL_VELOCITY, measured}};
+  for (const auto& profile : profiles) {
+    std::printf("Output modes, 48 in, %s\n", profile.name);
+    std::printf("  %-40s %8s %11s %10s %10s\n", "output", "time", "settle time", "overshoot", "end error");
+    for (sim::Conditions_t conditions : {sim::NOMINAL, sim::LOADED}) {
+      for (const auto& mode : modes) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s, %s", conditions.name, mode.name);
+        print(name, runMove(conditions, profile.enabled, mode.mode, mode.velocitySettings));
+      }
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
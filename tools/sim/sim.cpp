@@ -0,0 +1,282 @@
+/**
+ * @file tools/sim/sim.cpp
+ * @author LemLib Team
+ * @brief Host drivetrain simulation shared by the simulation tools
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "sim.hpp"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "../prosStubs.hpp"
+#include "lemlib/chassis/feedforwardFit.hpp"
+#include "lemlib/chassis/pathProfile.hpp"
+#include "lemlib/util.hpp"
+
+/**
+ * @brief Construct a new Drivetrain, at rest at the origin facing the y axis
+ *
+ * @param conditions the conditions to simulate
+ * @param constants the drivetrain constants. Only the track width, wheel diameter and rpm are used
+ */
+sim::Drivetrain::Drivetrain(Conditions_t conditions, lemlib::Drivetrain_t constants)
+    : freeSpeed(constants.wheelDiameter * M_PI * constants.rpm / 60),
+      constants(constants),
+      conditions(conditions) {
+  stubs::setTime(time + CLOCK_OFFSET);
+}
+
+/**
+ * @brief Set the power of each side, like pros::Motor_Group::move()
+ *
+ * @param left power of the left side, out of 127
+ * @param right power of the right side, out of 127
+ */
+void sim::Drivetrain::move(float left, float right) {
+  velocityMode = false;
+  leftPower = std::max(-127.0f, std::min(127.0f, left));
+  rightPower = std::max(-127.0f, std::min(127.0f, right));
+}
+
+/**
+ * @brief Set the velocity of each side, like pros::Motor_Group::move_velocity()
+ *
+ * The velocity controller built into the motors holds the velocity, see MOTOR_KP and MOTOR_KI
+ *
+ * @param left velocity of the left side, in inches per second
+ * @param right velocity of the right side, in inches per second
+ */
+void sim::Drivetrain::moveVelocity(float left, float right) {
+  if (!velocityMode) {
+    leftIntegral = 0;
+    rightIntegral = 0;
+  }
+  velocityMode = true;
+  leftTarget = left;
+  rightTarget = right;
+}
+
+/**
+ * @brief Get the power the velocity controller built into the motors applies to one side
+ *
+ * @param target target velocity of the side, in inches per second
+ * @param velocity velocity of the side, in inches per second
+ * @param integral integral of the velocity error, updated
+ * @return float power out of 127
+ */
+float sim::Drivetrain::motorVelocityPower(float target, float velocity, float& integral) {
+  // the motors know their free speed, so they feed it forward and correct the rest with a PI loop
+  float feedforward = target / freeSpeed * 127;
+  float proportional = MOTOR_KP * (target - velocity);
+  float power = feedforward + proportional + MOTOR_KI * integral;
+  // the integral stops growing while the output is saturated
+  if (std::fabs(power) < 127 || (power > 0) != (target - velocity > 0)) integral += (target - velocity) * DT;
+  return std::max(-127.0f, std::min(127.0f, feedforward + proportional + MOTOR_KI * integral));
+}
+
+/**
+ * @brief Advance one side of the drivetrain by DT
+ *
+ * @param velocity velocity of the side, updated
+ * @param power power of the side, out of 127
+ */
+void sim::Drivetrain::stepSide(float& velocity, float power) {
+  // the motors regulate their voltage to 12 V, but can't apply more than the battery has
+  float maxVoltage = std::min(12.0f, conditions.battery - 0.8f);
+  float voltage = std::max(-maxVoltage, std::min(maxVoltage, power * 12 / 127));
+  if (velocity == 0 && std::fabs(voltage) <= conditions.friction) return;  // static friction holds the wheels
+  float direction = (velocity != 0) ? (velocity > 0 ? 1 : -1) : (voltage > 0 ? 1 : -1);
+  float effective = voltage - conditions.friction * direction;
+  float next = velocity + (effective / 12 * freeSpeed - velocity) * DT / conditions.timeConstant;
+  // friction can stop the wheels, but not turn them the other way
+  if (next * direction < 0 && std::fabs(voltage) <= conditions.friction) next = 0;
+  velocity = next;
+}
+
+/**
+ * @brief Advance the simulation by DT
+ */
+void sim::Drivetrain::step() {
+  if (velocityMode) {
+    leftPower = motorVelocityPower(leftTarget, leftVelocity, leftIntegral);
+    rightPower = motorVelocityPower(rightTarget, rightVelocity, rightIntegral);
+  }
+  stepSide(leftVelocity, leftPower);
+  stepSide(rightVelocity, rightPower);
+  float linear = (leftVelocity + rightVelocity) / 2;
+  float angular = (leftVelocity - rightVelocity) / constants.trackWidth;  // clockwise
+  // integrate along the arc, using the heading halfway through the step
+  float theta = pose.theta + angular * DT / 2;
+  pose.x += linear * std::sin(theta) * DT;
+  pose.y += linear * std::cos(theta) * DT;
+  pose.theta += angular * DT;
+  time += DT;
+  stubs::setTime(time + CLOCK_OFFSET);
+}
+
+/**
+ * @brief Measure the wheel velocity constants of the simulated robot, like Chassis::characterize()
+ *
+ * @param conditions the conditions to measure in
+ * @param maxDistance the furthest the robot drives during each test, in inches
+ * @return lemlib::VelocityController_t the measured constants. kP is always 0
+ */
+lemlib::VelocityController_t sim::characterize(Conditions_t conditions, float maxDistance) {
+  constexpr float rampRate = 10;
+  constexpr float stepPower = 80;
+  lemlib::FeedforwardFit fit;
+
+  // quasi-static test
+  Drivetrain ramp(conditions);
+  for (int i = 0; ramp.pose.distance(lemlib::Pose(0, 0)) <= maxDistance; i++) {
+    float power = rampRate * i * DT;
+    if (power > 127) break;
+    ramp.move(power, power);
+    ramp.step();
+    fit.addRampSample(power, (ramp.leftVelocity + ramp.rightVelocity) / 2);
+  }
+  if (!fit.fitRamp()) return NO_VELOCITY_CONTROLLER;
+
+  // dynamic test, from rest
+  Drivetrain step(conditions);
+  float prevVelocity = 0;
+  while (step.pose.distance(lemlib::Pose(0, 0)) < maxDistance) {
+    step.move(-stepPower, -stepPower);
+    step.step();
+    float velocity = -(step.leftVelocity + step.rightVelocity) / 2;
+    float acceleration = (velocity - prevVelocity) / DT;
+    prevVelocity = velocity;
+    fit.addStepSample(stepPower, velocity, acceleration);
+  }
+  return fit.getConstants();
+}
+
+namespace {
+/**
+ * @brief Add an arc to a path, with a point every inch
+ *
+ * @param path the path, which must end where the arc starts
+ * @param centerX x position of the center of the arc
+ * @param centerY y position of the center of the arc
+ * @param radius radius of the arc
+ * @param start angle of the start of the arc from the center, counterclockwise from the x axis in radians
+ * @param sweep angle the arc sweeps, positive counterclockwise
+ */
+void addArc(sim::Path& path, float centerX, float centerY, float radius, float start, float sweep) {
+  int points = std::ceil(std::fabs(sweep) * radius);
+  for (int i = 1; i <= points; i++) {
+    float angle = start + sweep * i / points;
+    path.emplace_back(centerX + radius * std::cos(angle), centerY + radius * std::sin(angle), 127);
+  }
+}
+
+/**
+ * @brief Add a straight line to a path, with a point every inch
+ *
+ * @param path the path, which must end where the line starts
+ * @param x x position of the end of the line
+ * @param y y position of the end of the line
+ */
+void addLine(sim::Path& path, float x, float y) {
+  lemlib::Pose start = path.back();
+  int points = std::ceil(std::hypot(x - start.x, y - start.y));
+  for (int i = 1; i <= points; i++) {
+    path.emplace_back(start.x + (x - start.x) * i / points, start.y + (y - start.y) * i / points, 127);
+  }
+}
+}  // namespace
+
+/**
+ * @brief A path that drives 48 inches forward, then curves through a right angle with a 12 inch radius, then drives
+ * 36 inches to the right
+ *
+ * @return Path the path, with a point every inch and every point at full power
+ */
+sim::Path sim::cornerPath() {
+  Path path = {lemlib::Pose(0, 0, 127)};
+  addLine(path, 0, 48);
+  addArc(path, 12, 48, 12, M_PI, -M_PI_2);
+  addLine(path, 48, 60);
+  return path;
+}
+
+/**
+ * @brief A path that weaves through two opposite 90 degree arcs of 24 inch radius, ending 48 inches to the right and
+ * 48 inches forward of the start, facing forward
+ *
+ * @return Path the path, with a point every inch and every point at full power
+ */
+sim::Path sim::sCurvePath() {
+  Path path = {lemlib::Pose(0, 0, 127)};
+  addArc(path, 24, 0, 24, M_PI, -M_PI_2);
+  addArc(path, 24, 48, 24, -M_PI_2, M_PI_2);
+  return path;
+}
+
+/**
+ * @brief Get the distance from a point to a path
+ *
+ * @param path the path
+ * @param point the point
+ * @return float the distance to the closest segment of the path, in inches
+ */
+float sim::crossTrackError(const Path& path, lemlib::Pose point) {
+  float closest = INFINITY;
+  for (int i = 0; i < (int)path.size() - 1; i++) {
+    float dx = path[i + 1].x - path[i].x;
+    float dy = path[i + 1].y - path[i].y;
+    float length = dx * dx + dy * dy;
+    float t = (length > 0) ? ((point.x - path[i].x) * dx + (point.y - path[i].y) * dy) / length : 0;
+    t = std::max(0.0f, std::min(1.0f, t));
+    closest = std::min(closest, (float)std::hypot(path[i].x + dx * t - point.x, path[i].y + dy * t - point.y));
+  }
+  return closest;
+}
+
+/**
+ * @brief Construct a new Follow Recorder
+ *
+ * @param path the path, before it was profiled
+ */
+sim::FollowRecorder::FollowRecorder(const Path& path)
+    : path(path) {}
+
+/**
+ * @brief Record the position of the robot after a step of the simulation
+ *
+ * @param drivetrain the simulated drivetrain
+ */
+void sim::FollowRecorder::record(const Drivetrain& drivetrain) {
+  float error = crossTrackError(path, drivetrain.pose);
+  totalError += error;
+  maxError = std::max(maxError, error);
+  samples++;
+}
+
+/**
+ * @brief Let the robot coast to a stop with the motors off, then get the statistics
+ *
+ * @param drivetrain the simulated drivetrain, where the follower exited
+ * @return FollowStats_t the statistics
+ */
+sim::FollowStats_t sim::FollowRecorder::finish(Drivetrain& drivetrain) {
+  FollowStats_t stats;
+  stats.time = drivetrain.time;
+  stats.meanError = (samples > 0) ? totalError / samples : 0;
+  stats.maxError = maxError;
+  drivetrain.move(0, 0);
+  for (int i = 0; i < 300 && (drivetrain.leftVelocity != 0 || drivetrain.rightVelocity != 0); i++) drivetrain.step();
+  const lemlib::Pose& end = path.back();
+  const lemlib::Pose& beforeEnd = path.at(path.size() - 2);
+  stats.endError = std::hypot(drivetrain.pose.x - end.x, drivetrain.pose.y - end.y);
+  float endHeading = std::atan2(end.x - beforeEnd.x, end.y - beforeEnd.y);
+  stats.endHeadingError = std::fabs(lemlib::angleError(drivetrain.pose.theta, endHeading, true)) * 180 / M_PI;
+  return stats;
+}
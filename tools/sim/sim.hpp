@@ -0,0 +1,239 @@
+/**
+ * @file tools/sim/sim.hpp
+ * @author LemLib Team
+ * @brief Host drivetrain simulation shared by the simulation tools
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/pose.hpp"
+
+namespace sim {
+/**
+ * @brief Period of the simulation and of the control loops, in seconds
+ */
+constexpr float DT = 0.01;
+
+/**
+ * @brief Time pros::millis() reads when a simulation starts, in seconds
+ *
+ * The clock of the robot has been running for a while when a motion starts. FAPID takes a time of 0 to mean a timer
+ * is not running
+ */
+constexpr float CLOCK_OFFSET = 1;
+
+/**
+ * @brief Conditions the robot is simulated in
+ *
+ * @param name name shown in the results
+ * @param battery battery voltage. The motors can apply up to 0.8 V less than this, and never more than 12 V
+ * @param friction voltage lost to friction in each side of the drivetrain
+ * @param timeConstant time the wheels take to reach 63% of a new free speed, in seconds. Grows with the weight of
+ * the robot
+ */
+typedef struct {
+  const char* name;
+  float battery;
+  float friction;
+  float timeConstant;
+} Conditions_t;
+
+/**
+ * @brief A charged battery and a robot without a game object
+ */
+constexpr Conditions_t NOMINAL = {"nominal", 12.8, 0.8, 0.2};
+
+/**
+ * @brief A drained battery, a robot carrying a game object and worn bearings
+ */
+constexpr Conditions_t LOADED = {"loaded", 11.2, 1.6, 0.3};
+
+/**
+ * @brief The drivetrain of the robot in src/main.cpp. The motor groups are not used
+ */
+constexpr lemlib::Drivetrain_t DRIVETRAIN = {nullptr, nullptr, 10, 3.25, 360, 0, 80, 60, 60, 0};
+
+/**
+ * @brief Velocity control disabled
+ */
+constexpr lemlib::VelocityController_t NO_VELOCITY_CONTROLLER = {0, 0, 0, 0};
+
+/**
+ * @brief Proportional gain of the velocity controller built into the motors, in power per inch per second
+ */
+constexpr float MOTOR_KP = 4;
+
+/**
+ * @brief Integral gain of the velocity controller built into the motors, in power per inch
+ */
+constexpr float MOTOR_KI = 20;
+
+/**
+ * @brief A differential drivetrain driven by DC motors
+ *
+ * Each side accelerates toward the free speed of the voltage applied to it, minus the voltage lost to friction,
+ * with a first order lag. A side that is stopped stays stopped until its voltage overcomes friction. The pose uses
+ * the same convention as lemlib::Pose: theta is in radians, clockwise from the y axis
+ */
+class Drivetrain {
+ public:
+  /**
+   * @brief Construct a new Drivetrain, at rest at the origin facing the y axis. Resets the clock of pros::millis()
+   *
+   * @param conditions the conditions to simulate
+   * @param constants the drivetrain constants. Only the track width, wheel diameter and rpm are used
+   */
+  Drivetrain(Conditions_t conditions, lemlib::Drivetrain_t constants = DRIVETRAIN);
+  /**
+   * @brief Set the power of each side, like pros::Motor_Group::move()
+   *
+   * @param left power of the left side, out of 127
+   * @param right power of the right side, out of 127
+   */
+  void move(float left, float right);
+  /**
+   * @brief Set the velocity of each side, like pros::Motor_Group::move_velocity()
+   *
+   * The velocity controller built into the motors holds the velocity, see MOTOR_KP and MOTOR_KI
+   *
+   * @param left velocity of the left side, in inches per second
+   * @param right velocity of the right side, in inches per second
+   */
+  void moveVelocity(float left, float right);
+  /**
+   * @brief Advance the simulation by DT, and the clock of pros::millis() with it
+   */
+  void step();
+
+  lemlib::Pose pose = lemlib::Pose(0, 0, 0);
+  float leftVelocity = 0;  // in inches per second
+  float rightVelocity = 0;  // in inches per second
+  float time = 0;  // in seconds
+  const float freeSpeed;  // wheel speed at 12 V without friction, in inches per second
+  const lemlib::Drivetrain_t constants;
+ private:
+  /**
+   * @brief Advance one side of the drivetrain by DT
+   *
+   * @param velocity velocity of the side, updated
+   * @param power power of the side, out of 127
+   */
+  void stepSide(float& velocity, float power);
+  /**
+   * @brief Get the power the velocity controller built into the motors applies to one side
+   *
+   * @param target target velocity of the side, in inches per second
+   * @param velocity velocity of the side, in inches per second
+   * @param integral integral of the velocity error, updated
+   * @return float power out of 127
+   */
+  float motorVelocityPower(float target, float velocity, float& integral);
+
+  Conditions_t conditions;
+  float leftPower = 0;
+  float rightPower = 0;
+  bool velocityMode = false;  // whether the motors hold a velocity instead of a power
+  float leftTarget = 0;  // in inches per second
+  float rightTarget = 0;  // in inches per second
+  float leftIntegral = 0;
+  float rightIntegral = 0;
+};
+
+/**
+ * @brief Measure the wheel velocity constants of the simulated robot, like Chassis::characterize()
+ *
+ * Runs the same ramp and step tests, with the default ramp rate and step power, and fits them with the real
+ * lemlib::FeedforwardFit. Resets the clock of pros::millis()
+ *
+ * @param conditions the conditions to measure in
+ * @param maxDistance the furthest the robot drives during each test, in inches
+ * @return lemlib::VelocityController_t the measured constants. kP is always 0
+ */
+lemlib::VelocityController_t characterize(Conditions_t conditions, float maxDistance);
+
+/**
+ * @brief A path, with the velocity of each point in theta like the path files read by lemlib::getData()
+ */
+typedef std::vector<lemlib::Pose> Path;
+
+/**
+ * @brief A path that drives 48 inches forward, then curves through a right angle with a 12 inch radius, then drives
+ * 36 inches to the right
+ *
+ * @return Path the path, with a point every inch and every point at full power
+ */
+Path cornerPath();
+
+/**
+ * @brief A path that weaves through two opposite 90 degree arcs of 24 inch radius, ending 48 inches to the right and
+ * 48 inches forward of the start, facing forward
+ *
+ * @return Path the path, with a point every inch and every point at full power
+ */
+Path sCurvePath();
+
+/**
+ * @brief Get the distance from a point to a path
+ *
+ * @param path the path
+ * @param point the point
+ * @return float the distance to the closest segment of the path, in inches
+ */
+float crossTrackError(const Path& path, lemlib::Pose point);
+
+/**
+ * @brief Statistics of a robot following a path
+ *
+ * @param time time until the follower exited, in seconds
+ * @param meanError mean distance from the path while following it, in inches
+ * @param maxError largest distance from the path while following it, in inches
+ * @param endError distance from the end of the path once the robot stopped, in inches
+ * @param endHeadingError difference from the heading at the end of the path once the robot stopped, in degrees
+ */
+typedef struct {
+  float time;
+  float meanError;
+  float maxError;
+  float endError;
+  float endHeadingError;
+} FollowStats_t;
+
+/**
+ * @brief Measures how closely a robot follows a path
+ */
+class FollowRecorder {
+ public:
+  /**
+   * @brief Construct a new Follow Recorder
+   *
+   * @param path the path, before it was profiled
+   */
+  FollowRecorder(const Path& path);
+  /**
+   * @brief Record the position of the robot after a step of the simulation
+   *
+   * @param drivetrain the simulated drivetrain
+   */
+  void record(const Drivetrain& drivetrain);
+  /**
+   * @brief Let the robot coast to a stop with the motors off, then get the statistics
+   *
+   * @param drivetrain the simulated drivetrain, where the follower exited
+   * @return FollowStats_t the statistics
+   */
+  FollowStats_t finish(Drivetrain& drivetrain);
+ private:
+  Path path;
+  double totalError = 0;
+  float maxError = 0;
+  int samples = 0;
+};
+}  // namespace sim
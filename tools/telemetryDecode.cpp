@@ -0,0 +1,171 @@
+/**
+ * @file tools/telemetryDecode.cpp
+ * @author LemLib Team
+ * @brief Host decoder for binary telemetry captures
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Turns a raw capture of the serial terminal into one CSV file per record type.
+// Build on Linux with: g++ -std=c++17 -O2 -I../include telemetryDecode.cpp -o telemetryDecode
+// Usage: telemetryDecode capture.bin output
+// writes output_pose.csv, output_motor.csv, output_controller.csv and output_channels.csv, and prints the bandwidth
+// per record type
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lemlib/telemetryFormat.hpp"
+
+using namespace lemlib::telemetry;
+
+/**
+ * @brief Count of the records of one type, for the bandwidth summary
+ */
+struct TypeStats {
+  const char* name;
+  unsigned long records = 0;
+  unsigned long bytes = 0;
+};
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    std::fprintf(stderr, "usage: %s <capture> <output prefix>\n", argv[0]);
+    return 1;
+  }
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file.is_open()) {
+    std::fprintf(stderr, "could not open %s\n", argv[1]);
+    return 1;
+  }
+  std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  std::string prefix = argv[2];
+  FILE* pose = std::fopen((prefix + "_pose.csv").c_str(), "w");
+  FILE* motor = std::fopen((prefix + "_motor.csv").c_str(), "w");
+  FILE* controller = std::fopen((prefix + "_controller.csv").c_str(), "w");
+  FILE* channels = std::fopen((prefix + "_channels.csv").c_str(), "w");
+  if (pose == nullptr || motor == nullptr || controller == nullptr || channels == nullptr) {
+    std::fprintf(stderr, "could not create the output files\n");
+    return 1;
+  }
+  std::fprintf(pose, "time_ms,x,y,theta\n");
+  std::fprintf(motor, "time_ms,port,voltage_mv,velocity_rpm,current_ma\n");
+  std::fprintf(controller, "time_ms,id,error,output\n");
+  std::fprintf(channels, "time_ms,channel,index,value\n");
+  // names of the channels, by id. Samples of channels whose name hasn't been seen yet are written with their id
+  std::map<int, std::string> channelNames;
+
+  TypeStats stats[] = {{"pose"}, {"motor"}, {"controller"}, {"channels"}, {"channel names"}};
+  unsigned long skipped = 0, corrupt = 0;
+  std::uint32_t firstTime = 0, lastTime = 0;
+  bool first = true;
+  std::size_t i = 0;
+  while (i + FRAME_OVERHEAD <= data.size()) {
+    // look for the start of a frame, anything else is text printed to the terminal
+    if (data[i] != SYNC_1 || data[i + 1] != SYNC_2) {
+      i++;
+      skipped++;
+      continue;
+    }
+    FrameHeader header;
+    std::memcpy(&header, &data[i], sizeof(header));
+    std::size_t size = sizeof(header) + header.length + 1;
+    if (i + size > data.size()) break;  // the capture ended in the middle of the frame
+    if (crc8(&data[i + 2], size - 3) != data[i + size - 1]) {
+      // not a real frame, or a corrupted one. Resynchronize on the next byte
+      i++;
+      corrupt++;
+      continue;
+    }
+    const std::uint8_t* payload = &data[i + sizeof(header)];
+    int typeIndex = -1;
+    switch (static_cast<RecordType>(header.type)) {
+      case RecordType::POSE:
+        if (header.length == sizeof(PoseRecord)) {
+          PoseRecord record;
+          std::memcpy(&record, payload, sizeof(record));
+          std::fprintf(pose, "%u,%f,%f,%f\n", header.time, record.x, record.y, record.theta);
+          typeIndex = 0;
+        }
+        break;
+      case RecordType::MOTOR:
+        if (header.length == sizeof(MotorRecord)) {
+          MotorRecord record;
+          std::memcpy(&record, payload, sizeof(record));
+          std::fprintf(motor, "%u,%u,%d,%.1f,%d\n", header.time, record.port, record.voltage, record.velocity / 10.0,
+                       record.current);
+          typeIndex = 1;
+        }
+        break;
+      case RecordType::CONTROLLER:
+        if (header.length == sizeof(ControllerRecord)) {
+          ControllerRecord record;
+          std::memcpy(&record, payload, sizeof(record));
+          std::fprintf(controller, "%u,%u,%f,%f\n", header.time, record.id, record.error, record.output);
+          typeIndex = 2;
+        }
+        break;
+      case RecordType::CHANNEL_NAME:
+        if (header.length >= sizeof(ChannelName)) {
+          ChannelName record;
+          std::memcpy(&record, payload, sizeof(record));
+          channelNames[record.id] =
+              std::string(reinterpret_cast<const char*>(payload + sizeof(record)), header.length - sizeof(record));
+          typeIndex = 4;
+        }
+        break;
+      case RecordType::CHANNELS: {
+        // a list of samples, each a ChannelSample followed by count floats
+        std::size_t offset = 0;
+        while (offset + sizeof(ChannelSample) <= header.length) {
+          ChannelSample sample;
+          std::memcpy(&sample, payload + offset, sizeof(sample));
+          offset += sizeof(sample);
+          if (offset + sample.count * sizeof(float) > header.length) break;
+          auto name = channelNames.find(sample.id);
+          std::string channel = (name != channelNames.end()) ? name->second : std::to_string(sample.id);
+          for (int value = 0; value < sample.count; value++) {
+            float number;
+            std::memcpy(&number, payload + offset + value * sizeof(float), sizeof(number));
+            std::fprintf(channels, "%u,%s,%d,%f\n", header.time, channel.c_str(), value, number);
+          }
+          offset += sample.count * sizeof(float);
+        }
+        typeIndex = 3;
+        break;
+      }
+    }
+    if (typeIndex >= 0) {
+      stats[typeIndex].records++;
+      stats[typeIndex].bytes += size;
+      if (first) firstTime = header.time;
+      first = false;
+      lastTime = header.time;
+    }
+    i += size;
+  }
+  std::fclose(pose);
+  std::fclose(motor);
+  std::fclose(controller);
+  std::fclose(channels);
+
+  // bandwidth summary
+  double seconds = (lastTime - firstTime) / 1000.0;
+  std::fprintf(stderr, "%-14s %10s %14s %12s\n", "type", "records", "bytes/record", "bytes/s");
+  for (const TypeStats& type : stats) {
+    if (type.records == 0) continue;
+    std::fprintf(stderr, "%-14s %10lu %14.1f %12.1f\n", type.name, type.records, (double)type.bytes / type.records,
+                 (seconds > 0) ? type.bytes / seconds : 0.0);
+  }
+  std::fprintf(stderr, "%lu bytes of text skipped, %lu corrupt frames\n", skipped, corrupt);
+  return 0;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file tools/traceConvert.cpp
+ * @author LemLib Team
+ * @brief Host converter from saved profiler traces to Chrome traces
+ * @version 0.4.5
+ * @date 2023-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+// Turns a trace saved by lemlib::profiler::dump() into Chrome trace_event JSON, which can be opened in
+// chrome://tracing or ui.perfetto.dev. Each task is shown as its own thread.
+// Build on Linux with: g++ -std=c++17 -O2 -I../include traceConvert.cpp -o traceConvert
+// Usage: traceConvert trace.bin trace.json
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "lemlib/profiler.hpp"
+
+using namespace lemlib::profiler;
+
+/**
+ * @brief Read a list of names, each a length byte then the characters
+ *
+ * @param data the file
+ * @param offset where the names start. Moved past the names
+ * @param count number of names
+ * @param names output names
+ * @return true if all the names were read
+ */
+bool readNames(const std::vector<std::uint8_t>& data, std::size_t& offset, int count, std::vector<std::string>& names) {
+  for (int i = 0; i < count; i++) {
+    if (offset >= data.size() || offset + 1 + data[offset] > data.size()) return false;
+    std::size_t length = data[offset];
+    names.emplace_back(reinterpret_cast<const char*>(&data[offset + 1]), length);
+    offset += 1 + length;
+  }
+  return true;
+}
+
+/**
+ * @brief Write a string as a JSON string
+ *
+ * @param file the output file
+ * @param text the string
+ */
+void writeString(FILE* file, const std::string& text) {
+  std::fputc('"', file);
+  for (char c : text) {
+    if (c == '"' || c == '\\') std::fputc('\\', file);
+    if (static_cast<unsigned char>(c) >= 0x20) std::fputc(c, file);
+  }
+  std::fputc('"', file);
+}
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    std::fprintf(stderr, "usage: %s <trace.bin> <trace.json>\n", argv[0]);
+    return 1;
+  }
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file.is_open()) {
+    std::fprintf(stderr, "could not open %s\n", argv[1]);
+    return 1;
+  }
+  std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  TraceHeader_t header;
+  if (data.size() < sizeof(header)) {
+    std::fprintf(stderr, "%s is not a trace\n", argv[1]);
+    return 1;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  std::size_t offset = sizeof(header);
+  std::vector<std::string> names, tasks;
+  if (std::memcmp(header.magic, "LLTR", 4) != 0 || !readNames(data, offset, header.nameCount, names) ||
+      !readNames(data, offset, header.taskCount, tasks)) {
+    std::fprintf(stderr, "%s is not a trace\n", argv[1]);
+    return 1;
+  }
+
+  FILE* output = std::fopen(argv[2], "w");
+  if (output == nullptr) {
+    std::fprintf(stderr, "could not create %s\n", argv[2]);
+    return 1;
+  }
+  std::fprintf(output, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  // name the threads after the tasks
+  for (std::size_t task = 0; task < tasks.size(); task++) {
+    std::fprintf(output, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":", task);
+    writeString(output, tasks[task]);
+    std::fprintf(output, "}},\n");
+  }
+
+  // the oldest events may have lost their begin events when the ring buffer wrapped, so each task keeps track of
+  // how many sections are open and ends without a begin are skipped
+  std::vector<int> depth(tasks.size(), 0);
+  std::uint64_t wraps = 0;
+  std::uint32_t prevTime = 0;
+  unsigned long written = 0, skipped = 0;
+  for (std::uint32_t i = 0; i < header.eventCount; i++) {
+    TraceRecord_t record;
+    if (offset + sizeof(record) > data.size()) break;  // the file was cut off
+    std::memcpy(&record, &data[offset], sizeof(record));
+    offset += sizeof(record);
+    if (record.name >= names.size() || record.task >= tasks.size()) {
+      skipped++;
+      continue;
+    }
+    // the time is 32 bits of microseconds, which wraps around every 71 minutes
+    if (i > 0 && record.time < prevTime && prevTime - record.time > 0x80000000u) wraps++;
+    prevTime = record.time;
+    if (record.phase == 'B') {
+      depth[record.task]++;
+    } else if (depth[record.task] > 0) {
+      depth[record.task]--;
+    } else {
+      skipped++;
+      continue;
+    }
+    std::fprintf(output, "{\"name\":");
+    writeString(output, names[record.name]);
+    std::fprintf(output, ",\"ph\":\"%c\",\"ts\":%llu,\"pid\":1,\"tid\":%u},\n", record.phase == 'B' ? 'B' : 'E',
+                 (unsigned long long)((wraps << 32) + record.time), record.task);
+    written++;
+  }
+  // JSON does not allow a trailing comma, so the list ends with the name of the process
+  std::fprintf(output, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"V5 brain\"}}\n]}\n");
+  std::fclose(output);
+  std::fprintf(stderr, "%lu events written, %lu skipped\n", written, skipped);
+  return 0;
+}